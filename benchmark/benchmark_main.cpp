@@ -6,13 +6,19 @@ SET_LOADER(PuzzleLoader("../9x9.csv", 1000000UL, 9));
 /****************************************************************************************/
 ADD_SOLVER(Solvers::DepthFirstSolver(), DepthFirst)
 ADD_SOLVER(Solvers::DepthFirstSolverV1(), DepthFirstV1)
-// ADD_SOLVER(Solvers::GeometricAnnealingSolver(20, 50, 1500, 0.95), GeometricAnnealing)
+// ADD_SOLVER(Solvers::GeometricAnnealingSolver(20, 50, 0, 0.9), GeometricAnnealing)
+// ADD_SOLVER(Solvers::AdaptiveAnnealingSolver(20, 50, 0, 0.5, 0.9), AdaptiveAnnealing)
+// ADD_SOLVER(Solvers::LundyMeesAnnealingSolver(20, 50, 0, 0.1), LundyMeesAnnealing)
+// ADD_SOLVER(Solvers::ParallelTemperingSolver(0, 1000, 2, 0.8), ParallelTempering)
 ADD_SOLVER(Solvers::AdditiveGraphSolver(100), AdditiveGraph)
 ADD_SOLVER(Solvers::SimpleAdditiveGraphSolver(100), SimpleAdditiveGraph)
 ADD_SOLVER(Solvers::MultiplicativeGraphSolver(100), MultiplicativeGraph)
+ADD_SOLVER(Solvers::HybridGraphSolver(20), HybridGraph)
+// ADD_SOLVER(Solvers::CachingSolver(new Solvers::HybridGraphSolver(20)), CachedHybridGraph)
+// ADD_SOLVER(Solvers::PortfolioSolver({new Solvers::DepthFirstSolver(), new Solvers::HybridGraphSolver(20)}), Portfolio)
+// ADD_SOLVER(Solvers::BatchSolver(), Batch)
 /****************************************************************************************/
 
 int main(int argc, char **argv) {
-	RUN_BENCHMARKS(argc, argv);
-	return 0;
+	return RUN_BENCHMARKS(argc, argv);
 }
\ No newline at end of file
@@ -1,17 +1,25 @@
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 #include <chrono>
+#include <cstring>
+#include <thread>
 
 #include "puzzle.h"
 #include "display.h"
 #include "data.h"
 #include "solvers.h"
+#include "trace.h"
 
 // #define DEBUG_ENABLED
 // #define DEBUG_ENABLED_VERBOSE
 #include "debugging.h"
 
 #include "benchmarking.h"
+#include "histogram.h"
+#include "report.h"
+#include "throughput.h"
+#include "perf_counters.h"
 
 using namespace std;
 
@@ -21,25 +29,22 @@ BenchmarkPuzzleLoader * BenchmarkPuzzleLoader::GetInstance() {
 	return &bpl;
 }
 
-SolverList * SolverList::GetInstance() {
-	DEBUG_OUTPUT("SolverList::GetInstance()")
-    static SolverList sl;
-    return &sl;
-}
-
 SolverList::SolverList(unsigned maxcap) : maxcap(maxcap), capinc(maxcap), curcap(0) {
 	DEBUG_OUTPUT("SolverList::SolverList(%d)", maxcap)
     solvers = new Solvers::Solver*[maxcap];
     names = new std::string[maxcap];
+    params = new std::string[maxcap];
 }
 
 SolverList::~SolverList() {
 	DEBUG_OUTPUT("SolverList::~SolverList()")
     for (unsigned i = 0; i < curcap; i++) delete solvers[i];
     delete[] solvers;
+    delete[] names;
+    delete[] params;
 }
 
-int SolverList::addSolver(Solvers::Solver *solver, std::string name) {
+int SolverList::addSolver(Solvers::Solver *solver, std::string name, std::string params) {
 	DEBUG_FUNC_HEADER("SolverList::addSolver(Solver, %s)", name.c_str())
     if (curcap >= maxcap) {
 		DEBUG_OUTPUT("Capacity overflow detected")
@@ -49,11 +54,13 @@ int SolverList::addSolver(Solvers::Solver *solver, std::string name) {
 		DEBUG_OUTPUT("Increasing capacity from %d to %d", oldcap, maxcap)
         Solvers::Solver **solversExt = new Solvers::Solver*[maxcap];
         std::string *namesExt = new std::string[maxcap];
+        std::string *paramsExt = new std::string[maxcap];
 
 		DEBUG_OUTPUT("Transferring items to newly allocated memory")
         for (unsigned i = 0; i < curcap; i++) {
             solversExt[i] = solvers[i];
             namesExt[i] = names[i];
+            paramsExt[i] = this->params[i];
         }
 
 		DEBUG_OUTPUT("Freeing previously allocated memory")
@@ -61,9 +68,12 @@ int SolverList::addSolver(Solvers::Solver *solver, std::string name) {
         solvers = solversExt;
 		delete[] names;
 		names = namesExt;
+		delete[] this->params;
+		this->params = paramsExt;
     }
 	DEBUG_OUTPUT("Appending solver info to list")
     names[curcap] = name;
+    this->params[curcap] = params;
     solvers[curcap++] = solver;
 
 	DEBUG_FUNC_RETURN(0)
@@ -75,7 +85,10 @@ typedef struct time_compare_t {
 	const unsigned numTests;
 
 	unsigned * solves;
-	unsigned ** durations;
+	uint64_t ** durations; // nanoseconds per test
+	LatencyHistogram * latencies; // nanoseconds per puzzle
+	perf_sample_t * counters; // hardware counters over every test
+	solver_stats_t * stats; // search effort over every test
 
 	time_compare_t(unsigned numSolvers, unsigned numTests) :
 		numSolvers(numSolvers), numTests(numTests)
@@ -83,17 +96,23 @@ typedef struct time_compare_t {
 		solves = new unsigned[numSolvers];
 		for (unsigned *cursor = solves, *cursorMax = solves + numSolvers; cursor < cursorMax; cursor++)
 			*cursor = 0;
-		durations = new unsigned*[numSolvers];
-		for (unsigned **cursor = durations, **cursorMax = durations + numSolvers; cursor < cursorMax; cursor++)
-			*cursor = new unsigned[numTests];
+		durations = new uint64_t*[numSolvers];
+		for (uint64_t **cursor = durations, **cursorMax = durations + numSolvers; cursor < cursorMax; cursor++)
+			*cursor = new uint64_t[numTests];
+		latencies = new LatencyHistogram[numSolvers];
+		counters = new perf_sample_t[numSolvers];
+		stats = new solver_stats_t[numSolvers];
 	}
 
 	~time_compare_t() {
 		delete[] solves;
 
-		for (unsigned **cursor = durations, **cursorMax = durations + numSolvers; cursor < cursorMax; cursor++)
+		for (uint64_t **cursor = durations, **cursorMax = durations + numSolvers; cursor < cursorMax; cursor++)
 			delete[] *cursor;
 		delete[] durations;
+		delete[] latencies;
+		delete[] counters;
+		delete[] stats;
 	}
 } time_compare_t;
 
@@ -103,12 +122,26 @@ void compareSolvers(
 	unsigned numSolvers,
 	std::string *names,
 	Solvers::Solver **solvers,
-	time_compare_t &timeCompare
+	time_compare_t &timeCompare,
+	unsigned warmup,
+	PerfCounters *counters,
+	uint64_t timeout,
+	uint64_t budget,
+	bool batch,
+	ostream &out
 ) {
-	DEBUG_FUNC_HEADER("compareSolvers(%d, %d, %d, string*, Solver**, time_compare_t&)", numTests, numPuzzles, numSolvers)
+	DEBUG_FUNC_HEADER("compareSolvers(%d, %d, %d, string*, Solver**, time_compare_t&, %d, PerfCounters*, %llu, %llu, %d, ostream&)", 
+		numTests, numPuzzles, numSolvers, warmup, (unsigned long long) timeout, (unsigned long long) budget, batch)
 	Puzzle puzzles[numPuzzles]; 
+	SolveStatus statuses[numPuzzles];
 
-	unsigned start, stop, duration, numSolved;
+	// every puzzle gets its own deadline, timeout nanoseconds after its solve starts
+	solve_options_t limits;
+	limits.budget = budget;
+	bool bounded = timeout || budget;
+
+	uint64_t duration;
+	unsigned numSolved, numStopped;
 	for (unsigned testNum = 0; testNum < numTests; testNum++) {
 		// Sample puzzles
 		DEBUG_OUTPUT("Sampling %d Puzzles", numPuzzles)
@@ -124,26 +157,54 @@ void compareSolvers(
 			Solvers::Solver &solver = *solvers[solverNum];
 			std::string &name = names[solverNum];
 
+			// Warm up caches and branch predictors on the first sample, untimed
+			for (unsigned round = 0; testNum == 0 && round < warmup; round++) {
+				if (batch) solver.solveBatch(puzzles, numPuzzles);
+				for (Puzzle *puzzle = puzzles, *puzzleMax = puzzles + numPuzzles; puzzle < puzzleMax; puzzle++) {
+					if (!batch) solver.solve(*puzzle);
+					puzzle->reset();
+				}
+			}
+
 			// Test solver 
 			DEBUG_OUTPUT("Running %s solver", name.c_str())
-			start = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
-			for (Puzzle *puzzle = puzzles, *puzzleMax = puzzles + numPuzzles; puzzle < puzzleMax; puzzle++) {
-				solver.solve(*puzzle);
+			solver.resetStats();
+			LatencyHistogram &latencies = timeCompare.latencies[solverNum];
+			duration = 0;
+			numSolved = numStopped = 0;
+			if (counters) counters->start();
+			if (batch) {
+				// the sample is one call, so every puzzle is charged the average latency
+				chrono::steady_clock::time_point start = chrono::steady_clock::now();
+				solver.solveBatch(puzzles, numPuzzles, statuses);
+				duration = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+				for (unsigned i = 0; i < numPuzzles; i++) {
+					latencies.record(duration / numPuzzles);
+					numSolved += statuses[i] == SolveStatus::Solved;
+				}
 			}
-			stop = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+			for (Puzzle *puzzle = puzzles, *puzzleMax = puzzles + numPuzzles; !batch && puzzle < puzzleMax; puzzle++) {
+				if (timeout) limits.timeout(chrono::nanoseconds(timeout));
+				Solvers::solve_result_t result = solver.solve(*puzzle, limits);
+				latencies.record(result.elapsed);
+				duration += result.elapsed;
+				numSolved += result.isSolved();
+				numStopped += result.status == SolveStatus::BudgetExhausted || result.status == SolveStatus::TimedOut;
+			}
+			if (counters) timeCompare.counters[solverNum] += counters->stop();
+			timeCompare.stats[solverNum] += solver.getStats();
 			
 			DEBUG_IF_THEN(numPuzzles == 1, Display::showPuzzle(*puzzles))
 
 			// Track stats
-			duration = stop - start;
 			timeCompare.durations[solverNum][testNum] = duration;
 
-			numSolved = 0;
-			for (unsigned i = 0; i < numPuzzles; i++) numSolved += puzzles[i].isSolved();
 			timeCompare.solves[solverNum] += numSolved;
 
-			cout << name << " solver solved " << numSolved << " out of " << numPuzzles << " puzzles in " 
-				<< setprecision(5) << duration * 1e-3 << " seconds\n";
+			out << name << " solver solved " << numSolved << " out of " << numPuzzles << " puzzles in " 
+				<< setprecision(5) << duration * 1e-9 << " seconds";
+			if (bounded) out << " (" << numStopped << " stopped by the limits)";
+			out << '\n';
 
 			// Reset
 			DEBUG_OUTPUT("Resetting Puzzles")
@@ -153,25 +214,18 @@ void compareSolvers(
 	DEBUG_FUNC_END()
 }
 
-void displayComparisonStats(
-	unsigned numTests, 
-	unsigned numPuzzles, 
-	unsigned numSolvers, 
-	std::string *names, 
-	time_compare_t &timeCompare
-) {
-	DEBUG_OUTPUT("displayComparisonStats(%d, %d, %d, string*, time_compare_t&)", numTests, numPuzzles, numSolvers)
+// Computes the mean and sample variance of each solver's time per test, in nanoseconds
+void computeTimeStats(unsigned numTests, unsigned numSolvers, time_compare_t &timeCompare, double *means, double *vars) {
+	double *meanMax = means + numSolvers, *varMax = vars + numSolvers;
+
 	// initialize means and variances
-	double means[numSolvers], *meanMax = means + numSolvers;
-	double vars[numSolvers], *varMax = vars + numSolvers;
-	double effs[numSolvers*numSolvers], *effsMax = effs + numSolvers*numSolvers;
 	for (double *mean = means, *var = vars; mean < meanMax; mean++, var++) 
 		*mean = *var = 0;
 
 	// compute means
-	unsigned **durations = timeCompare.durations;
+	uint64_t **durations = timeCompare.durations;
 	for (double *mean = means; mean < meanMax; mean++, durations++)
-		for (unsigned *duration = *durations, *durationMax = duration + numTests; duration < durationMax; duration++)
+		for (uint64_t *duration = *durations, *durationMax = duration + numTests; duration < durationMax; duration++)
 			*mean += *duration;
 	for (double *mean = means; mean < meanMax; mean++)
 		*mean /= numTests;
@@ -180,9 +234,9 @@ void displayComparisonStats(
 	// compute variances
 	if (numTests > 1) {
 		double temp;
-		unsigned **durations = timeCompare.durations;
+		uint64_t **durations = timeCompare.durations;
 		for (double *mean = means, *var = vars; var < varMax; var++, mean++, durations++) {
-			for (unsigned *duration = *durations, *durationMax = duration + numTests; duration < durationMax; duration++) {
+			for (uint64_t *duration = *durations, *durationMax = duration + numTests; duration < durationMax; duration++) {
 				temp = *duration - *mean;
 				*var += temp * temp;
 			}
@@ -190,6 +244,21 @@ void displayComparisonStats(
 		for (double *var = vars; var < varMax; var++)
 			*var /= numTests - 1;
 	}
+}
+
+void displayComparisonStats(
+	unsigned numTests, 
+	unsigned numPuzzles, 
+	unsigned numSolvers, 
+	std::string *names, 
+	time_compare_t &timeCompare,
+	ostream &out
+) {
+	DEBUG_OUTPUT("displayComparisonStats(%d, %d, %d, string*, time_compare_t&, ostream&)", numTests, numPuzzles, numSolvers)
+	double means[numSolvers], *meanMax = means + numSolvers;
+	double vars[numSolvers];
+	double effs[numSolvers*numSolvers], *effsMax = effs + numSolvers*numSolvers;
+	computeTimeStats(numTests, numSolvers, timeCompare, means, vars);
 
 	// compute compared efficiency metrics
 	unsigned *solve1 = timeCompare.solves;
@@ -208,68 +277,438 @@ void displayComparisonStats(
 		*nameLength = name->length();
 		if (*nameLength > maxNameLength) maxNameLength = *nameLength;
 	}
-	cout << "\n\n";
+	out << "\n\n";
 
 	// display stats
 	unsigned statwidth = 12;
 	unsigned numstats = 4;
-	cout << "|" << setw(maxNameLength+1) << "STATS" << " |"
+	out << "|" << setw(maxNameLength+1) << "STATS" << " |"
 		 << setw(statwidth) << "Time Mean" << " |"
 		 << setw(statwidth) << "Time Var" << " |"
 		 << setw(statwidth) << "Solved" << " |"
 		 << setw(statwidth) << "Solve Rate" << " |\n";
-	cout << '+' << setw(maxNameLength+3) << setfill('=') << '+';
+	out << '+' << setw(maxNameLength+3) << setfill('=') << '+';
 	for (unsigned j = 0; j < numstats; j++) {
-		cout << setw(statwidth+2) << '+';
+		out << setw(statwidth+2) << '+';
 	}
-	cout << setfill(' ') << '\n';
+	out << setfill(' ') << '\n';
 	double solveFactor = 100. / (numTests * numPuzzles);
 	for (unsigned i = 0; i < numSolvers; i++) {
-		cout << "|" << setw(maxNameLength+1) << names[i] << " |"
-		 	 << setw(statwidth-1) << means[i] * 1e-3 << "s |"
-		 	 << setw(statwidth-1) << vars[i] * 1e-6 << "s |"
+		out << "|" << setw(maxNameLength+1) << names[i] << " |"
+		 	 << setw(statwidth-1) << means[i] * 1e-9 << "s |"
+		 	 << setw(statwidth-1) << vars[i] * 1e-18 << "s |"
 		 	 << setw(statwidth) << timeCompare.solves[i] << " |"
 			 << setw(statwidth-1) << timeCompare.solves[i] * solveFactor << "% |\n";
 	}
-	cout << '\n';
+	out << '\n';
+
+	// display per puzzle latency percentiles
+	const double percentiles[] = {50, 90, 99, 99.9};
+	out << "|" << setw(maxNameLength+1) << "LATENCY" << " |"
+		 << setw(statwidth) << "p50" << " |"
+		 << setw(statwidth) << "p90" << " |"
+		 << setw(statwidth) << "p99" << " |"
+		 << setw(statwidth) << "p99.9" << " |"
+		 << setw(statwidth) << "Max" << " |\n";
+	out << '+' << setw(maxNameLength+3) << setfill('=') << '+';
+	for (unsigned j = 0; j < 5; j++) {
+		out << setw(statwidth+2) << '+';
+	}
+	out << setfill(' ') << '\n';
+	for (unsigned i = 0; i < numSolvers; i++) {
+		LatencyHistogram &latencies = timeCompare.latencies[i];
+		out << "|" << setw(maxNameLength+1) << names[i] << " |";
+		for (double percentile : percentiles)
+			out << setw(statwidth-2) << latencies.percentile(percentile) * 1e-6 << "ms |";
+		out << setw(statwidth-2) << latencies.getMax() * 1e-6 << "ms |\n";
+	}
+	out << '\n';
+
+	// display hardware counters per puzzle
+	bool anyCounters = false;
+	for (unsigned i = 0; i < numSolvers; i++) anyCounters = anyCounters || timeCompare.counters[i].any();
+	if (anyCounters) {
+		const PerfCounter shown[] = {PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_MISSES, PERF_BRANCH_MISSES, PERF_PAGE_FAULTS};
+		out << "|" << setw(maxNameLength+1) << "PER PUZZLE" << " |"
+			 << setw(statwidth) << "Cycles" << " |"
+			 << setw(statwidth) << "Instructions" << " |"
+			 << setw(statwidth) << "IPC" << " |"
+			 << setw(statwidth) << "Cache Miss" << " |"
+			 << setw(statwidth) << "Branch Miss" << " |"
+			 << setw(statwidth) << "Page Faults" << " |\n";
+		out << '+' << setw(maxNameLength+3) << setfill('=') << '+';
+		for (unsigned j = 0; j < 6; j++) {
+			out << setw(statwidth+2) << '+';
+		}
+		out << setfill(' ') << '\n';
+		double perPuzzle = 1. / (numTests * numPuzzles);
+		for (unsigned i = 0; i < numSolvers; i++) {
+			const perf_sample_t &sample = timeCompare.counters[i];
+			out << "|" << setw(maxNameLength+1) << names[i] << " |";
+			for (unsigned j = 0; j < 5; j++) {
+				PerfCounter counter = shown[j];
+				if (sample.available[counter]) out << setw(statwidth) << sample.values[counter] * perPuzzle << " |";
+				else out << setw(statwidth) << "n/a" << " |";
+				if (counter != PERF_INSTRUCTIONS) continue;
+				if (sample.available[PERF_CYCLES] && sample.available[PERF_INSTRUCTIONS] && sample.values[PERF_CYCLES])
+					out << setw(statwidth) << static_cast<double>(sample.values[PERF_INSTRUCTIONS]) / sample.values[PERF_CYCLES] << " |";
+				else out << setw(statwidth) << "n/a" << " |";
+			}
+			out << '\n';
+		}
+		out << '\n';
+	}
+
+#ifdef SUDOKU_STATS_ENABLED
+	// display search effort per puzzle
+	out << "|" << setw(maxNameLength+1) << "SEARCH EFFORT" << " |"
+		 << setw(statwidth) << "Nodes" << " |"
+		 << setw(statwidth) << "Backtracks" << " |"
+		 << setw(statwidth) << "Eliminations" << " |"
+		 << setw(statwidth) << "Moves" << " |"
+		 << setw(statwidth) << "Accepted %" << " |"
+		 << setw(statwidth) << "Reheats" << " |"
+		 << setw(statwidth) << "Iterations" << " |"
+		 << setw(statwidth) << "Collapses/It" << " |\n";
+	out << '+' << setw(maxNameLength+3) << setfill('=') << '+';
+	for (unsigned j = 0; j < 8; j++) {
+		out << setw(statwidth+2) << '+';
+	}
+	out << setfill(' ') << '\n';
+	double perPuzzle = 1. / (numTests * numPuzzles);
+	for (unsigned i = 0; i < numSolvers; i++) {
+		const solver_stats_t &stats = timeCompare.stats[i];
+		out << "|" << setw(maxNameLength+1) << names[i] << " |"
+			 << setw(statwidth) << stats.nodes * perPuzzle << " |"
+			 << setw(statwidth) << stats.backtracks * perPuzzle << " |"
+			 << setw(statwidth) << stats.eliminations * perPuzzle << " |"
+			 << setw(statwidth) << stats.movesProposed * perPuzzle << " |";
+		if (stats.movesProposed) out << setw(statwidth) << 100. * stats.movesAccepted / stats.movesProposed << " |";
+		else out << setw(statwidth) << "n/a" << " |";
+		out << setw(statwidth) << stats.reheats * perPuzzle << " |"
+			 << setw(statwidth) << stats.iterations * perPuzzle << " |";
+		if (stats.iterations) out << setw(statwidth) << static_cast<double>(stats.collapses) / stats.iterations << " |";
+		else out << setw(statwidth) << "n/a" << " |";
+		out << '\n';
+	}
+	out << '\n';
+#endif
 
 	// display comparison
 	unsigned widths[numSolvers];
-	cout << "|" << setw(maxNameLength+1) << "Puzzle/Puzzle" << " |";
+	out << "|" << setw(maxNameLength+1) << "Puzzle/Puzzle" << " |";
 	for (unsigned j = 0; j < numSolvers; j++) {
 		unsigned w = (maxNameLength - nameLengths[j]) / 2 + 1;
 		widths[j] = w*2 + nameLengths[j];
-		cout << setw(w) << "";
-		cout << names[j];
-		cout << setw(w) << "";
-		cout << "|";
+		out << setw(w) << "";
+		out << names[j];
+		out << setw(w) << "";
+		out << "|";
 	}
-	cout << '\n' << '+' << setw(maxNameLength+3) << setfill('=') << '+';
+	out << '\n' << '+' << setw(maxNameLength+3) << setfill('=') << '+';
 	for (unsigned j = 0; j < numSolvers; j++) {
-		cout << setw(widths[j]+1) << '+';
+		out << setw(widths[j]+1) << '+';
 	}
-	cout << setfill(' ') << '\n';
+	out << setfill(' ') << '\n';
 	double *eff = effs;
 	for (unsigned i = 0; i < numSolvers; i++) {
-		cout << "|" << setw(maxNameLength+1) << names[i] << " |";
+		out << "|" << setw(maxNameLength+1) << names[i] << " |";
 		for (unsigned j = 0; j < numSolvers; j++, eff++) {
-			cout << setw(widths[j]) << *eff << "|";
+			out << setw(widths[j]) << *eff << "|";
 		}
-		cout << '\n';
+		out << '\n';
 	}
 }
 
-void RUN_BENCHMARKS(int argc, char **argv) {
-	DEBUG_FUNC_HEADER("RUN_BENCHMARKS(%d, char**)", argc)
-	unsigned numPuzzles = 1, numTests = 1;
-	if (argc > 1) numPuzzles = atoi(argv[1]); 
-	if (argc > 2) numTests = atoi(argv[2]);
+benchmark_report_t buildReport(
+	unsigned numTests, 
+	unsigned numPuzzles, 
+	unsigned numSolvers, 
+	std::string *names, 
+	std::string *params, 
+	time_compare_t &timeCompare
+) {
+	DEBUG_OUTPUT("buildReport(%d, %d, %d, string*, string*, time_compare_t&)", numTests, numPuzzles, numSolvers)
+	double means[numSolvers], vars[numSolvers];
+	computeTimeStats(numTests, numSolvers, timeCompare, means, vars);
+
+	const PuzzleLoader &loader = SUDOKU_PUZZLE_LOADER;
+	benchmark_report_t report;
+	report.dataset = loader.getFile();
+	report.datasetSize = loader.getDatasetSize();
+	report.puzzleSize = loader.getPuzzleSize();
+	report.numPuzzles = numPuzzles;
+	report.numTests = numTests;
+	report.host = host_info_t::collect();
+	for (unsigned i = 0; i < numSolvers; i++) {
+		LatencyHistogram &latencies = timeCompare.latencies[i];
+		solver_report_t solver;
+		solver.name = names[i];
+		solver.params = params[i];
+		solver.tests = numTests;
+		solver.attempted = numTests * numPuzzles;
+		solver.solved = timeCompare.solves[i];
+		solver.mean = means[i] * 1e-9;
+		solver.variance = vars[i] * 1e-18;
+		solver.p50 = latencies.percentile(50);
+		solver.p90 = latencies.percentile(90);
+		solver.p99 = latencies.percentile(99);
+		solver.p999 = latencies.percentile(99.9);
+		solver.max = latencies.getMax();
+		solver.counters = timeCompare.counters[i];
+		solver.stats = timeCompare.stats[i];
+		report.solvers.push_back(solver);
+	}
+	return report;
+}
 
-	time_compare_t timeCompare {NUM_SOLVERS, numTests};
+typedef struct benchmark_options_t {
+	unsigned numPuzzles = 1;
+	unsigned numTests = 1;
+	unsigned warmup = 0;
+	string dataset;
+	unsigned long datasetSize = 0;
+	unsigned puzzleSize = 0;
+	bool seeded = false;
+	unsigned seed = 0;
+	unsigned threads = 0;
+	unsigned throughput = 0;
+	uint64_t timeout = 0; // nanoseconds per puzzle
+	uint64_t budget = 0;
+	bool batch = false;
+	bool counters = false;
+	string tracePath;
+	string format = "table";
+	string output;
+	string jsonPath, csvPath, baselinePath;
+	vector<string> solvers;
+	bool list = false;
+} benchmark_options_t;
+
+static void printUsage(ostream &out) {
+	out << "Usage: benchmark [numPuzzles [numTests]] [options]\n"
+		<< "  --puzzles n          puzzles per test (default 1)\n"
+		<< "  --tests n            number of tests (default 1)\n"
+		<< "  --warmup n           untimed rounds over the first sample per solver (default 0)\n"
+		<< "  --dataset path       puzzle csv file\n"
+		<< "  --dataset-size n     number of puzzles in the csv file\n"
+		<< "  --size n             puzzle rank, e.g. 9\n"
+		<< "  --seed n             puzzle sampling seed (0 loads in order) and solver seed\n"
+		<< "  --threads n          threads for multithreaded solvers\n"
+		<< "  --throughput n       measure throughput over 1..n threads instead of comparing\n"
+		<< "  --timeout ms         stop every solve after ms milliseconds\n"
+		<< "  --budget n           stop every solve after n units of work (nodes, proposals, iterations)\n"
+		<< "  --batch              hand each sample to the solvers in one call (solveBatch)\n"
+		<< "  --solver spec        Name or Name:key=value,... (repeatable, default every preset)\n"
+		<< "  --format f           table, json or csv (default table)\n"
+		<< "  --output path        write the json or csv report to path instead of stdout\n"
+		<< "  --json path          also write a json report\n"
+		<< "  --csv path           also write a csv report\n"
+		<< "  --baseline path      compare with a csv report, exit 1 on regression\n"
+		<< "  --counters           collect hardware performance counters (Linux perf_event_open)\n"
+		<< "  --trace path         write the solvers' trace events to path (TRACE builds only)\n"
+		<< "  --list               list the available solvers and their parameters\n";
+}
 
-	compareSolvers(numTests, numPuzzles, NUM_SOLVERS, SOLVER_NAMES, SOLVERS, timeCompare);
-	displayComparisonStats(numTests, numPuzzles, NUM_SOLVERS, SOLVER_NAMES, timeCompare);
+// Returns false and explains why if the command line is invalid
+static bool parseOptions(int argc, char **argv, benchmark_options_t &options) {
+	unsigned positional = 0;
+	for (int arg = 1; arg < argc; arg++) {
+		const char *flag = argv[arg];
+		if (flag[0] != '-') {
+			if (positional == 0) options.numPuzzles = atoi(flag);
+			else if (positional == 1) options.numTests = atoi(flag);
+			else {
+				cerr << "Unexpected argument: " << flag << '\n';
+				return false;
+			}
+			positional++;
+			continue;
+		}
+		if (!strcmp(flag, "--list")) { options.list = true; continue; }
+		if (!strcmp(flag, "--counters")) { options.counters = true; continue; }
+		if (!strcmp(flag, "--batch")) { options.batch = true; continue; }
+		if (!strcmp(flag, "-h") || !strcmp(flag, "--help")) return false;
+		if (arg + 1 >= argc) {
+			cerr << "Missing value for " << flag << '\n';
+			return false;
+		}
+		const char *value = argv[++arg];
+		if (!strcmp(flag, "--puzzles")) options.numPuzzles = atoi(value);
+		else if (!strcmp(flag, "--tests")) options.numTests = atoi(value);
+		else if (!strcmp(flag, "--warmup")) options.warmup = atoi(value);
+		else if (!strcmp(flag, "--dataset")) options.dataset = value;
+		else if (!strcmp(flag, "--dataset-size")) options.datasetSize = strtoul(value, nullptr, 0);
+		else if (!strcmp(flag, "--size")) options.puzzleSize = atoi(value);
+		else if (!strcmp(flag, "--seed")) { options.seeded = true; options.seed = strtoul(value, nullptr, 0); }
+		else if (!strcmp(flag, "--threads")) options.threads = atoi(value);
+		else if (!strcmp(flag, "--throughput")) options.throughput = atoi(value);
+		else if (!strcmp(flag, "--timeout")) options.timeout = static_cast<uint64_t>(strtod(value, nullptr) * 1e6);
+		else if (!strcmp(flag, "--budget")) options.budget = strtoull(value, nullptr, 0);
+		else if (!strcmp(flag, "--solver")) options.solvers.push_back(value);
+		else if (!strcmp(flag, "--format")) options.format = value;
+		else if (!strcmp(flag, "--output")) options.output = value;
+		else if (!strcmp(flag, "--json")) options.jsonPath = value;
+		else if (!strcmp(flag, "--csv")) options.csvPath = value;
+		else if (!strcmp(flag, "--baseline")) options.baselinePath = value;
+		else if (!strcmp(flag, "--trace")) options.tracePath = value;
+		else {
+			cerr << "Unknown flag: " << flag << '\n';
+			return false;
+		}
+	}
+	if (options.format != "table" && options.format != "json" && options.format != "csv") {
+		cerr << "Unknown format: " << options.format << '\n';
+		return false;
+	}
+	if (options.numPuzzles == 0 || options.numTests == 0) {
+		cerr << "At least one puzzle and one test are required\n";
+		return false;
+	}
+	if (options.batch && (options.timeout || options.budget)) {
+		cerr << "--batch solves without limits, so it cannot be combined with --timeout or --budget\n";
+		return false;
+	}
+#ifndef SUDOKU_TRACE_ENABLED
+	if (!options.tracePath.empty()) {
+		cerr << "--trace requires a build with the TRACE option\n";
+		return false;
+	}
+#endif
+	return true;
+}
+
+// Measures every solver over a shared pool of numPuzzles puzzles with 1..throughput
+// threads. Returns nonzero if a solver is unknown or appears not to be thread-safe.
+static int runThroughput(const benchmark_options_t &options, const vector<string> &specs, const SolverParams &defaults) {
+	DEBUG_FUNC_HEADER("runThroughput(options, specs[%d], defaults)", (int) specs.size())
+	SolverRegistry &registry = *SolverRegistry::GetInstance();
+	vector<Puzzle> pool(options.numPuzzles);
+	for (Puzzle &puzzle : pool) {
+		Puzzle temp = SUDOKU_PUZZLE_LOADER.load();
+		puzzle.swap(temp);
+	}
 
+	cout << "Throughput over " << pool.size() << " puzzles (" << thread::hardware_concurrency() << " hardware threads)\n";
+	int status = 0;
+	for (const string &spec : specs) {
+		string error;
+		delete registry.create(spec, error, defaults);
+		if (!error.empty()) {
+			cerr << error << '\n';
+			DEBUG_FUNC_RETURN(1)
+			return 1;
+		}
+		throughput_result_t result = measureThroughput(
+			[&]() { return registry.create(spec, error, defaults); }, pool, options.throughput);
+		displayThroughput(spec, result, cout);
+		if (!result.threadSafe) status = 1;
+	}
 	cout << endl;
-	DEBUG_FUNC_END()
+	DEBUG_FUNC_RETURN(status)
+	return status;
+}
+
+int RUN_BENCHMARKS(int argc, char **argv) {
+	DEBUG_FUNC_HEADER("RUN_BENCHMARKS(%d, char**)", argc)
+	benchmark_options_t options;
+	SolverRegistry &registry = *SolverRegistry::GetInstance();
+	if (!parseOptions(argc, argv, options)) {
+		printUsage(cerr);
+		DEBUG_FUNC_RETURN(1)
+		return 1;
+	}
+	if (options.list) {
+		cout << registry.usage();
+		DEBUG_FUNC_RETURN(0)
+		return 0;
+	}
+
+	// the dataset flags override the loader given to SET_LOADER
+	if (!options.dataset.empty() || options.datasetSize || options.puzzleSize || options.seeded) {
+		PuzzleLoader &loader = SUDOKU_PUZZLE_LOADER;
+		BenchmarkPuzzleLoader::GetInstance()->setLoader(new PuzzleLoader(
+			options.dataset.empty() ? loader.getFile() : options.dataset,
+			options.datasetSize ? options.datasetSize : loader.getDatasetSize(),
+			options.puzzleSize ? options.puzzleSize : loader.getPuzzleSize(),
+			options.seeded ? options.seed : loader.getSeed()
+		));
+	}
+
+	// instantiate the selected solvers, or every preset
+	SolverParams defaults;
+	if (options.seeded) defaults.set("seed", to_string(options.seed));
+	if (options.threads) {
+		defaults.set("replicas", to_string(options.threads));
+		defaults.set("threads", to_string(options.threads));
+	}
+	vector<string> specs = options.solvers.empty() ? registry.getPresetNames() : options.solvers;
+	if (options.throughput) {
+		int status = runThroughput(options, specs, defaults);
+		DEBUG_FUNC_RETURN(status)
+		return status;
+	}
+	SolverList solvers;
+	for (const string &spec : specs) {
+		string error;
+		Solvers::Solver *solver = registry.create(spec, error, defaults);
+		if (solver == nullptr) {
+			cerr << error << '\n';
+			DEBUG_FUNC_RETURN(1)
+			return 1;
+		}
+		solvers.addSolver(solver, spec, registry.describe(spec));
+	}
+
+	// keep stdout clean when it carries a machine-readable report
+	bool reportToStdout = options.format != "table" && options.output.empty();
+	ostream &out = reportToStdout ? cerr : cout;
+
+	// counters are optional: without kernel support the comparison runs without them
+	PerfCounters *counters = nullptr;
+	if (options.counters) {
+		counters = new PerfCounters();
+		if (!counters->getError().empty())
+			cerr << "Some performance counters are unavailable (" << counters->getError() << ")\n";
+		if (!counters->available()) {
+			delete counters;
+			counters = nullptr;
+		}
+	}
+
+	unsigned numPuzzles = options.numPuzzles, numTests = options.numTests, numSolvers = solvers.getNumSolvers();
+	time_compare_t timeCompare {numSolvers, numTests};
+
+	if (!options.tracePath.empty()) TraceLog::GetInstance().clear();
+	compareSolvers(numTests, numPuzzles, numSolvers, solvers.getSolverNames(), solvers.getSolvers(), timeCompare, options.warmup, counters, 
+		options.timeout, options.budget, options.batch, out);
+	delete counters;
+	if (!options.tracePath.empty() && !TraceLog::GetInstance().write(options.tracePath))
+		cerr << "Could not write trace " << options.tracePath << '\n';
+	displayComparisonStats(numTests, numPuzzles, numSolvers, solvers.getSolverNames(), timeCompare, out);
+
+	int status = 0;
+	benchmark_report_t report = buildReport(numTests, numPuzzles, numSolvers, solvers.getSolverNames(), solvers.getSolverParams(), timeCompare);
+	auto writeReport = [&](const string &format, const string &path) {
+		ofstream file;
+		if (!path.empty()) file.open(path);
+		ostream &target = path.empty() ? cout : file;
+		if (format == "json") writeJsonReport(target, report);
+		else writeCsvReport(target, report);
+	};
+	if (options.format != "table") writeReport(options.format, options.output);
+	if (!options.jsonPath.empty()) writeReport("json", options.jsonPath);
+	if (!options.csvPath.empty()) writeReport("csv", options.csvPath);
+	if (!options.baselinePath.empty()) {
+		vector<solver_report_t> baseline;
+		if (!readCsvReport(options.baselinePath, baseline)) {
+			cerr << "Could not read baseline report " << options.baselinePath << '\n';
+			status = 2;
+		}
+		else if (compareWithBaseline(report, baseline, out)) status = 1;
+	}
+
+	out << endl;
+	DEBUG_FUNC_RETURN(status)
+	return status;
 }
\ No newline at end of file
@@ -5,8 +5,12 @@
 #include <string>
 
 #include "data.h"
+#include "registry.h"
 
-void RUN_BENCHMARKS(int argc, char **argv);
+// Runs the comparison configured by the command line (see the README) and returns
+// the process exit code: nonzero for bad options, or if a baseline was given and 
+// a regression against it was detected
+int RUN_BENCHMARKS(int argc, char **argv);
 
 class BenchmarkPuzzleLoader {
     private:
@@ -26,6 +30,7 @@ class SolverList {
     private:
         Solvers::Solver **solvers;
         std::string *names;
+        std::string *params;
 
         const unsigned capinc;
         unsigned curcap;
@@ -34,17 +39,16 @@ class SolverList {
     public:
         static const unsigned DEFAULT_CAPACITY = 5;
 
-        static SolverList * GetInstance();
-
         SolverList(unsigned maxcap = DEFAULT_CAPACITY);
         ~SolverList();
 
         int addSolver(Solvers::Solver *solver) { return addSolver(solver, std::to_string(curcap+1)); }
-        int addSolver(Solvers::Solver *solver, std::string name);
+        int addSolver(Solvers::Solver *solver, std::string name, std::string params = "");
 
         Solvers::Solver ** getSolvers() const { return solvers; };
         unsigned getNumSolvers() const { return curcap; }
         std::string * getSolverNames() const { return names; }
+        std::string * getSolverParams() const { return params; }
 };
 
 
@@ -56,16 +60,13 @@ int LoaderDummyClass_t::dummy = LoaderDummyClass_t::registerLoader();
 
 #define SUDOKU_PUZZLE_LOADER BenchmarkPuzzleLoader::GetInstance()->getLoader()
 
+// Registers a preset solver under name. Presets are benchmarked by default, or
+// selected by name with --solver.
 #define ADD_SOLVER(solverBase, name) struct SolverAddition_ ## name ## _t { \
         static int dummy; \
-        static int registerSolver() {SolverList::GetInstance()->addSolver(new solverBase, #name); return 0;} \
+        static int registerSolver() { return SolverRegistry::GetInstance()->addPreset( \
+            #name, []() -> Solvers::Solver * { return new solverBase; }, #solverBase); } \
 }; \
 int SolverAddition_ ## name ## _t::dummy = SolverAddition_ ## name ## _t::registerSolver();
 
-#define SOLVERS SolverList::GetInstance()->getSolvers()
-
-#define NUM_SOLVERS SolverList::GetInstance()->getNumSolvers()
-
-#define SOLVER_NAMES SolverList::GetInstance()->getSolverNames()
-
 #endif // SUDOKU_BENCHMARKING_H
\ No newline at end of file
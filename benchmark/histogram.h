@@ -0,0 +1,68 @@
+#ifndef SUDOKU_HISTOGRAM_H
+#define SUDOKU_HISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+#define HISTOGRAM_SUB_BITS 7 // linear sub-buckets per power of two (2^7), under 1% relative error
+
+// Log-bucketed latency histogram in the style of HdrHistogram. Values below
+// 2^HISTOGRAM_SUB_BITS are counted exactly, and every larger power of two is split
+// into 2^HISTOGRAM_SUB_BITS linear sub-buckets, so recording is O(1) and any
+// percentile is reported within 1/2^HISTOGRAM_SUB_BITS of the recorded value.
+class LatencyHistogram {
+    private:
+        static const unsigned SUB_BUCKETS = 1U << HISTOGRAM_SUB_BITS;
+        static const unsigned NUM_BUCKETS = (65 - HISTOGRAM_SUB_BITS) * SUB_BUCKETS;
+
+        std::vector<uint64_t> counts;
+        uint64_t count, total, minimum, maximum;
+
+        static unsigned indexOf(uint64_t value) {
+            if (value < SUB_BUCKETS) return value;
+            unsigned shift = 63 - __builtin_clzll(value) - HISTOGRAM_SUB_BITS;
+            return (shift + 1) * SUB_BUCKETS + (value >> shift) - SUB_BUCKETS;
+        }
+        // largest value counted in the bucket at index
+        static uint64_t highestValueAt(unsigned index) {
+            if (index < 2 * SUB_BUCKETS) return index;
+            unsigned shift = index / SUB_BUCKETS - 1;
+            uint64_t top = SUB_BUCKETS + index % SUB_BUCKETS;
+            return ((top + 1) << shift) - 1;
+        }
+
+    public:
+        LatencyHistogram() : counts(NUM_BUCKETS, 0), count(0), total(0), minimum(UINT64_MAX), maximum(0) {};
+
+        void record(uint64_t value) {
+            counts[indexOf(value)]++;
+            count++;
+            total += value;
+            if (value < minimum) minimum = value;
+            if (value > maximum) maximum = value;
+        }
+
+        // value at or below which percent% of the recorded values fall
+        uint64_t percentile(double percent) const {
+            if (count == 0) return 0;
+            uint64_t target = static_cast<uint64_t>(percent / 100 * count + 0.5);
+            if (target == 0) target = 1;
+            uint64_t cumulative = 0;
+            for (unsigned index = 0; index < NUM_BUCKETS; index++) {
+                cumulative += counts[index];
+                if (cumulative >= target) {
+                    uint64_t value = highestValueAt(index);
+                    return value < maximum ? value : maximum;
+                }
+            }
+            return maximum;
+        }
+
+        uint64_t getCount() const { return count; }
+        uint64_t getTotal() const { return total; }
+        uint64_t getMin() const { return count ? minimum : 0; }
+        uint64_t getMax() const { return maximum; }
+        double getMean() const { return count ? static_cast<double>(total) / count : 0; }
+};
+
+#endif // SUDOKU_HISTOGRAM_H
@@ -0,0 +1,111 @@
+#include <cstring>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+#include "perf_counters.h"
+
+const char * perfCounterName(PerfCounter counter) {
+	switch (counter) {
+		case PERF_CYCLES: return "cycles";
+		case PERF_INSTRUCTIONS: return "instructions";
+		case PERF_CACHE_MISSES: return "cache-misses";
+		case PERF_BRANCH_MISSES: return "branch-misses";
+		case PERF_PAGE_FAULTS: return "page-faults";
+		default: return "unknown";
+	}
+}
+
+perf_sample_t & perf_sample_t::operator+=(const perf_sample_t &other) {
+	for (unsigned counter = 0; counter < PERF_NUM_COUNTERS; counter++) {
+		values[counter] += other.values[counter];
+		available[counter] = available[counter] || other.available[counter];
+	}
+	return *this;
+}
+
+bool perf_sample_t::any() const {
+	for (bool counter : available) if (counter) return true;
+	return false;
+}
+
+#ifdef __linux__
+
+PerfCounters::PerfCounters() {
+	DEBUG_FUNC_HEADER("PerfCounters::PerfCounters()")
+	static const struct { uint32_t type; uint64_t config; } events[PERF_NUM_COUNTERS] = {
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+		{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+		{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+	};
+	for (unsigned counter = 0; counter < PERF_NUM_COUNTERS; counter++) {
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = events[counter].type;
+		attr.config = events[counter].config;
+		attr.disabled = 1;
+		attr.inherit = 1; // include threads started by the solver
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		fds[counter] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		if (fds[counter] < 0 && error.empty())
+			error = std::string(perfCounterName(static_cast<PerfCounter>(counter))) + ": " + strerror(errno);
+	}
+	DEBUG_FUNC_END()
+}
+
+PerfCounters::~PerfCounters() {
+	for (int fd : fds) if (fd >= 0) close(fd);
+}
+
+bool PerfCounters::available() const {
+	for (int fd : fds) if (fd >= 0) return true;
+	return false;
+}
+
+void PerfCounters::start() {
+	for (int fd : fds) {
+		if (fd < 0) continue;
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+perf_sample_t PerfCounters::stop() {
+	perf_sample_t sample;
+	for (unsigned counter = 0; counter < PERF_NUM_COUNTERS; counter++) {
+		int fd = fds[counter];
+		if (fd < 0) continue;
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		uint64_t data[3]; // value, time enabled, time running
+		if (read(fd, data, sizeof(data)) != sizeof(data)) continue;
+		sample.available[counter] = true;
+		sample.values[counter] = data[2] && data[2] < data[1]
+			? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]) : data[0];
+	}
+	return sample;
+}
+
+#else
+
+PerfCounters::PerfCounters() : error("performance counters require Linux") {
+	for (int &fd : fds) fd = -1;
+}
+PerfCounters::~PerfCounters() {}
+bool PerfCounters::available() const { return false; }
+void PerfCounters::start() {}
+perf_sample_t PerfCounters::stop() { return perf_sample_t(); }
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef SUDOKU_PERF_COUNTERS_H
+#define SUDOKU_PERF_COUNTERS_H
+
+#include <cstdint>
+#include <string>
+
+enum PerfCounter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_PAGE_FAULTS,
+    PERF_NUM_COUNTERS
+};
+
+const char * perfCounterName(PerfCounter counter);
+
+// Counter totals. A counter which could not be opened stays unavailable, and
+// counts scheduled for only part of the time (multiplexed) are scaled up.
+typedef struct perf_sample_t {
+    uint64_t values[PERF_NUM_COUNTERS] = {};
+    bool available[PERF_NUM_COUNTERS] = {};
+
+    perf_sample_t & operator+=(const perf_sample_t &other);
+    bool any() const;
+} perf_sample_t;
+
+// Hardware and software event counters of the calling thread (and the threads it
+// starts while counting) via Linux perf_event_open. On other platforms, or when
+// the kernel refuses access (e.g. perf_event_paranoid), every counter is simply
+// unavailable and start/stop do nothing.
+class PerfCounters {
+    private:
+        int fds[PERF_NUM_COUNTERS];
+        std::string error;
+    public:
+        PerfCounters();
+        ~PerfCounters();
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters & operator=(const PerfCounters&) = delete;
+
+        bool available() const;
+        // reason the counters that are missing could not be opened
+        const std::string &getError() const { return error; }
+
+        void start();
+        perf_sample_t stop();
+};
+
+#endif // SUDOKU_PERF_COUNTERS_H
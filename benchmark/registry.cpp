@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+#include "registry.h"
+
+using namespace std;
+
+/*******************************************************\
+ * SolverParams
+\*******************************************************/
+
+bool SolverParams::parse(const string &text, SolverParams &params, string &error) {
+	size_t start = 0;
+	while (start < text.size()) {
+		size_t end = text.find(',', start);
+		if (end == string::npos) end = text.size();
+		string pair = text.substr(start, end - start);
+		size_t equals = pair.find('=');
+		if (equals == string::npos || equals == 0 || equals + 1 == pair.size()) {
+			error = "expected key=value but found \"" + pair + "\"";
+			return false;
+		}
+		params.values[pair.substr(0, equals)] = pair.substr(equals + 1);
+		start = end + 1;
+	}
+	return true;
+}
+
+const string * SolverParams::lookup(const string &key) const {
+	auto found = values.find(key);
+	if (found == values.end()) return nullptr;
+	used.insert(key);
+	return &found->second;
+}
+
+unsigned SolverParams::getUnsigned(const string &key, unsigned fallback) const {
+	const string *value = lookup(key);
+	return value ? strtoul(value->c_str(), nullptr, 0) : fallback;
+}
+
+uint64_t SolverParams::getUint64(const string &key, uint64_t fallback) const {
+	const string *value = lookup(key);
+	return value ? strtoull(value->c_str(), nullptr, 0) : fallback;
+}
+
+double SolverParams::getDouble(const string &key, double fallback) const {
+	const string *value = lookup(key);
+	return value ? strtod(value->c_str(), nullptr) : fallback;
+}
+
+string SolverParams::getString(const string &key, const string &fallback) const {
+	const string *value = lookup(key);
+	return value ? *value : fallback;
+}
+
+vector<string> SolverParams::keys() const {
+	vector<string> keys;
+	for (auto &pair : values) keys.push_back(pair.first);
+	return keys;
+}
+
+vector<string> SolverParams::unusedKeys() const {
+	vector<string> unused;
+	for (auto &pair : values) if (!used.count(pair.first)) unused.push_back(pair.first);
+	return unused;
+}
+
+/*******************************************************\
+ * SolverRegistry
+\*******************************************************/
+
+SolverRegistry * SolverRegistry::GetInstance() {
+	DEBUG_OUTPUT("SolverRegistry::GetInstance()")
+	static SolverRegistry registry;
+	return &registry;
+}
+
+void SolverRegistry::addFactory(const string &name, solver_factory_t factory, const string &usage) {
+	DEBUG_OUTPUT("SolverRegistry::addFactory(%s)", name.c_str())
+	factories[name] = {factory, usage};
+}
+
+int SolverRegistry::addPreset(const string &name, function<Solvers::Solver * ()> factory, const string &expression) {
+	DEBUG_OUTPUT("SolverRegistry::addPreset(%s, %s)", name.c_str(), expression.c_str())
+	if (!presets.count(name)) presetOrder.push_back(name);
+	presets[name] = {factory, expression};
+	return 0;
+}
+
+// annealing parameters shared by every schedule
+static void applyAnnealingParams(Solvers::AnnealingSolver *solver, const SolverParams &params) {
+	solver->setChainAcceptFraction(params.getDouble("accept", 1));
+}
+
+void SolverRegistry::addBuiltinFactories() {
+	using namespace Solvers;
+	const string annealing = "reheats=20,chains=50,t0=0 (calibrated),accept=1,seed";
+
+	addFactory("DepthFirst", [](const SolverParams &) { return new DepthFirstSolver(); }, "");
+	addFactory("DepthFirstV1", [](const SolverParams &) { return new DepthFirstSolverV1(); }, "");
+
+	addFactory("GeometricAnnealing", [](const SolverParams &p) {
+		AnnealingSolver *solver = new GeometricAnnealingSolver(p.getUnsigned("reheats", 20), p.getUnsigned("chains", 50),
+			p.getDouble("t0", 0), p.getDouble("factor", 0.9), p.getUint64("seed", RANDOM_DEFAULT_SEED));
+		applyAnnealingParams(solver, p);
+		return solver;
+	}, annealing + ",factor=0.9");
+	addFactory("LinearAnnealing", [](const SolverParams &p) {
+		AnnealingSolver *solver = new LinearAnnealingSolver(p.getUnsigned("reheats", 20), p.getUnsigned("chains", 50),
+			p.getDouble("t0", 0), p.getDouble("tf", 0.05), p.getUint64("seed", RANDOM_DEFAULT_SEED));
+		applyAnnealingParams(solver, p);
+		return solver;
+	}, annealing + ",tf=0.05");
+	addFactory("LogarithmicAnnealing", [](const SolverParams &p) {
+		AnnealingSolver *solver = new LogarithmicAnnealingSolver(p.getUnsigned("reheats", 20), p.getUnsigned("chains", 50),
+			p.getDouble("t0", 0), p.getUint64("seed", RANDOM_DEFAULT_SEED));
+		applyAnnealingParams(solver, p);
+		return solver;
+	}, annealing);
+	addFactory("LundyMeesAnnealing", [](const SolverParams &p) {
+		AnnealingSolver *solver = new LundyMeesAnnealingSolver(p.getUnsigned("reheats", 20), p.getUnsigned("chains", 50),
+			p.getDouble("t0", 0), p.getDouble("beta", 0.1), p.getUint64("seed", RANDOM_DEFAULT_SEED));
+		applyAnnealingParams(solver, p);
+		return solver;
+	}, annealing + ",beta=0.1");
+	addFactory("AdaptiveAnnealing", [](const SolverParams &p) {
+		AnnealingSolver *solver = new AdaptiveAnnealingSolver(p.getUnsigned("reheats", 20), p.getUnsigned("chains", 50),
+			p.getDouble("t0", 0), p.getDouble("target", 0.5), p.getDouble("decay", 0.9), p.getUint64("seed", RANDOM_DEFAULT_SEED));
+		applyAnnealingParams(solver, p);
+		return solver;
+	}, annealing + ",target=0.5,decay=0.9");
+	addFactory("ParallelTempering", [](const SolverParams &p) {
+		AnnealingSolver *solver = new ParallelTemperingSolver(p.getUnsigned("replicas", 0), p.getUnsigned("chains", 1000),
+			p.getDouble("t0", 2), p.getDouble("factor", 0.8), p.getUnsigned("exchange", 1), p.getUint64("seed", RANDOM_DEFAULT_SEED));
+		applyAnnealingParams(solver, p);
+		return solver;
+	}, "replicas=0 (threads),chains=1000,t0=2,factor=0.8,exchange=1,accept=1,seed");
+
+	addFactory("AdditiveGraph", [](const SolverParams &p)
+		{ return new AdditiveGraphSolver(p.getUnsigned("iters", 1000)); }, "iters=1000");
+	addFactory("SimpleAdditiveGraph", [](const SolverParams &p)
+		{ return new SimpleAdditiveGraphSolver(p.getUnsigned("iters", 1000)); }, "iters=1000");
+	addFactory("MultiplicativeGraph", [](const SolverParams &p)
+		{ return new MultiplicativeGraphSolver(p.getUnsigned("iters", 1000)); }, "iters=1000");
+	addFactory("HybridGraph", [](const SolverParams &p)
+		{ return new HybridGraphSolver(p.getUnsigned("iters", HYBRID_DEFAULT_GRAPH_ITERS)); }, "iters=20");
+	addFactory("Batch", [](const SolverParams &) { return new BatchSolver(); }, "");
+
+	// the inner solver is a bare name, as its own parameters would need commas
+	addFactory("Cached", [this](const SolverParams &p) -> Solver * {
+		string error;
+		Solver *inner = create(p.getString("inner", "HybridGraph"), error);
+		if (!inner) return nullptr;
+		return new CachingSolver(inner, make_shared<SolutionCache>(p.getUnsigned("capacity", CACHE_DEFAULT_CAPACITY),
+			p.getUnsigned("shards", CACHE_DEFAULT_SHARDS)));
+	}, "inner=HybridGraph,capacity=65536,shards=16");
+
+	// engines are bare names joined by +, for the same reason
+	addFactory("Portfolio", [this](const SolverParams &p) -> Solver * {
+		vector<Solver *> engines;
+		string names = p.getString("engines", "DepthFirst+HybridGraph+GeometricAnnealing"), error;
+		for (size_t start = 0, end = 0; end != string::npos; start = end + 1) {
+			end = names.find('+', start);
+			Solver *engine = create(names.substr(start, end == string::npos ? end : end - start), error);
+			if (!engine) {
+				for (Solver *created : engines) delete created;
+				return nullptr;
+			}
+			engines.push_back(engine);
+		}
+		return new PortfolioSolver(engines, p.getUnsigned("threads", 0), p.getUnsigned("learn", 1));
+	}, "engines=DepthFirst+HybridGraph+GeometricAnnealing,threads=0 (one per engine),learn=1");
+}
+
+Solvers::Solver * SolverRegistry::create(const string &spec, string &error, const SolverParams &defaults) const {
+	DEBUG_FUNC_HEADER("SolverRegistry::create(%s)", spec.c_str())
+	size_t colon = spec.find(':');
+	string name = spec.substr(0, colon);
+
+	// a bare name prefers the preset registered by ADD_SOLVER
+	auto preset = presets.find(name);
+	if (colon == string::npos && preset != presets.end()) {
+		DEBUG_FUNC_END()
+		return preset->second.factory();
+	}
+
+	auto entry = factories.find(name);
+	if (entry == factories.end()) {
+		error = "unknown solver \"" + name + "\"";
+		DEBUG_FUNC_RETURN(nullptr)
+		return nullptr;
+	}
+
+	SolverParams params;
+	if (colon != string::npos && !SolverParams::parse(spec.substr(colon + 1), params, error)) {
+		error = name + ": " + error;
+		DEBUG_FUNC_RETURN(nullptr)
+		return nullptr;
+	}
+	vector<string> given = params.keys();
+	params.merge(defaults);
+	Solvers::Solver *solver = entry->second.factory(params);
+	if (!solver) {
+		error = name + ": could not be built from \"" + spec + "\"";
+		DEBUG_FUNC_RETURN(nullptr)
+		return nullptr;
+	}
+
+	// defaults may go unused, but every parameter in the specification must be understood
+	for (const string &key : params.unusedKeys()) {
+		if (find(given.begin(), given.end(), key) == given.end()) continue;
+		error = name + ": unknown parameter \"" + key + "\" (accepts " +
+			(entry->second.usage.empty() ? "none" : entry->second.usage) + ")";
+		delete solver;
+		DEBUG_FUNC_RETURN(nullptr)
+		return nullptr;
+	}
+	DEBUG_FUNC_END()
+	return solver;
+}
+
+string SolverRegistry::describe(const string &spec) const {
+	auto preset = presets.find(spec);
+	return preset == presets.end() ? spec : preset->second.expression;
+}
+
+string SolverRegistry::usage() const {
+	ostringstream out;
+	out << "Solvers (Name:key=value,...):\n";
+	for (auto &entry : factories) {
+		out << "  " << entry.first;
+		if (!entry.second.usage.empty()) out << "  [" << entry.second.usage << "]";
+		out << '\n';
+	}
+	out << "Presets (default set):\n";
+	for (const string &name : presetOrder) out << "  " << name << " = " << presets.at(name).expression << '\n';
+	return out.str();
+}
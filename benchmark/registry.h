@@ -0,0 +1,80 @@
+#ifndef SUDOKU_REGISTRY_H
+#define SUDOKU_REGISTRY_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <solvers.h>
+
+// Parameters of a solver specification, written as comma separated key=value
+// pairs after the solver name, e.g. "GeometricAnnealing:reheats=10,factor=0.95"
+class SolverParams {
+    private:
+        std::map<std::string, std::string> values;
+        mutable std::set<std::string> used;
+        const std::string *lookup(const std::string &key) const;
+    public:
+        // Returns false and describes the problem in error if text is malformed
+        static bool parse(const std::string &text, SolverParams &params, std::string &error);
+
+        bool empty() const { return values.empty(); }
+        void set(const std::string &key, const std::string &value) { values[key] = value; }
+        // adds every parameter of defaults which is not already set
+        void merge(const SolverParams &defaults) { values.insert(defaults.values.begin(), defaults.values.end()); }
+        std::vector<std::string> keys() const;
+
+        unsigned getUnsigned(const std::string &key, unsigned fallback) const;
+        uint64_t getUint64(const std::string &key, uint64_t fallback) const;
+        double getDouble(const std::string &key, double fallback) const;
+        std::string getString(const std::string &key, const std::string &fallback) const;
+
+        // keys that were given but never read by the factory
+        std::vector<std::string> unusedKeys() const;
+};
+
+typedef std::function<Solvers::Solver * (const SolverParams &)> solver_factory_t;
+
+// Creates solvers by name at runtime. Factories are registered for every built-in
+// solver class and accept parameters, while presets are fixed solver expressions
+// registered by ADD_SOLVER and form the default set of solvers to benchmark.
+class SolverRegistry {
+    private:
+        typedef struct factory_entry_t {
+            solver_factory_t factory;
+            std::string usage;
+        } factory_entry_t;
+        typedef struct preset_entry_t {
+            std::function<Solvers::Solver * ()> factory;
+            std::string expression;
+        } preset_entry_t;
+
+        std::map<std::string, factory_entry_t> factories;
+        std::map<std::string, preset_entry_t> presets;
+        std::vector<std::string> presetOrder;
+
+        void addBuiltinFactories();
+    public:
+        static SolverRegistry * GetInstance();
+
+        SolverRegistry() { addBuiltinFactories(); }
+
+        void addFactory(const std::string &name, solver_factory_t factory, const std::string &usage);
+        int addPreset(const std::string &name, std::function<Solvers::Solver * ()> factory, const std::string &expression);
+
+        // Creates a solver from "Name" or "Name:key=value,...". A bare name selects the
+        // preset of that name if there is one. Returns nullptr and sets error on failure.
+        // Parameters not given in the specification are looked up in defaults.
+        Solvers::Solver * create(const std::string &spec, std::string &error, const SolverParams &defaults = SolverParams()) const;
+
+        // Expression or specification describing what create(spec) would build
+        std::string describe(const std::string &spec) const;
+
+        const std::vector<std::string> &getPresetNames() const { return presetOrder; }
+        std::string usage() const;
+};
+
+#endif // SUDOKU_REGISTRY_H
@@ -0,0 +1,347 @@
+#include <cmath>
+#include <ctime>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+#include "report.h"
+
+using namespace std;
+
+#define REPORT_BETA_MAX_ITERS 200
+#define REPORT_BETA_EPSILON 3e-14
+
+host_info_t host_info_t::collect() {
+	host_info_t host;
+
+#ifdef _WIN32
+	const char *name = getenv("COMPUTERNAME");
+	host.hostname = name ? name : "unknown";
+	host.os = "windows";
+#else
+	char name[256] = {};
+	host.hostname = gethostname(name, sizeof(name) - 1) == 0 ? name : "unknown";
+	#if defined(__APPLE__)
+	host.os = "macos";
+	#elif defined(__linux__)
+	host.os = "linux";
+	#else
+	host.os = "unix";
+	#endif
+#endif
+
+#if defined(__clang__)
+	host.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+	host.compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+	host.compiler = "msvc " + to_string(_MSC_VER);
+#else
+	host.compiler = "unknown";
+#endif
+
+	char timestamp[32];
+	time_t now = time(NULL);
+	strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+	host.timestamp = timestamp;
+	host.cores = thread::hardware_concurrency();
+	return host;
+}
+
+/*******************************************************\
+ * Emitters
+\*******************************************************/
+
+static string jsonString(const string &text) {
+	ostringstream out;
+	out << '"';
+	for (char c : text) {
+		switch (c) {
+			case '"': out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n"; break;
+			case '\t': out << "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+					out << "\\u" << hex << setw(4) << setfill('0') << static_cast<int>(c) << dec << setfill(' ');
+				else out << c;
+		}
+	}
+	out << '"';
+	return out.str();
+}
+
+void writeJsonReport(ostream &out, const benchmark_report_t &report) {
+	DEBUG_OUTPUT("writeJsonReport(ostream&, benchmark_report_t&)")
+	const host_info_t &host = report.host;
+	out << setprecision(9);
+	out << "{\n"
+		<< "  \"host\": {\"hostname\": " << jsonString(host.hostname)
+		<< ", \"os\": " << jsonString(host.os)
+		<< ", \"compiler\": " << jsonString(host.compiler)
+		<< ", \"cores\": " << host.cores
+		<< ", \"timestamp\": " << jsonString(host.timestamp) << "},\n"
+		<< "  \"dataset\": {\"path\": " << jsonString(report.dataset)
+		<< ", \"size\": " << report.datasetSize
+		<< ", \"puzzleSize\": " << report.puzzleSize << "},\n"
+		<< "  \"puzzles\": " << report.numPuzzles << ",\n"
+		<< "  \"tests\": " << report.numTests << ",\n"
+		<< "  \"solvers\": [";
+	for (unsigned i = 0; i < report.solvers.size(); i++) {
+		const solver_report_t &solver = report.solvers[i];
+		out << (i ? ",\n" : "\n")
+			<< "    {\"name\": " << jsonString(solver.name)
+			<< ", \"params\": " << jsonString(solver.params)
+			<< ", \"attempted\": " << solver.attempted
+			<< ", \"solved\": " << solver.solved
+			<< ", \"meanSeconds\": " << solver.mean
+			<< ", \"varianceSeconds2\": " << solver.variance
+			<< ", \"latencyNanoseconds\": {\"p50\": " << solver.p50
+			<< ", \"p90\": " << solver.p90
+			<< ", \"p99\": " << solver.p99
+			<< ", \"p99.9\": " << solver.p999
+			<< ", \"max\": " << solver.max << "}";
+		if (solver.counters.any()) {
+			out << ", \"counters\": {";
+			bool first = true;
+			for (unsigned counter = 0; counter < PERF_NUM_COUNTERS; counter++) {
+				if (!solver.counters.available[counter]) continue;
+				out << (first ? "" : ", ") << jsonString(perfCounterName(static_cast<PerfCounter>(counter)))
+					<< ": " << solver.counters.values[counter];
+				first = false;
+			}
+			out << "}";
+		}
+#ifdef SUDOKU_STATS_ENABLED
+		const solver_stats_t &stats = solver.stats;
+		out << ", \"stats\": {\"nodes\": " << stats.nodes
+			<< ", \"backtracks\": " << stats.backtracks
+			<< ", \"eliminations\": " << stats.eliminations
+			<< ", \"movesProposed\": " << stats.movesProposed
+			<< ", \"movesAccepted\": " << stats.movesAccepted
+			<< ", \"reheats\": " << stats.reheats
+			<< ", \"iterations\": " << stats.iterations
+			<< ", \"collapses\": " << stats.collapses << "}";
+#endif
+		out << "}";
+	}
+	out << "\n  ]\n}\n";
+}
+
+static string csvField(const string &text) {
+	if (text.find_first_of(",\"\n") == string::npos) return text;
+	string quoted = "\"";
+	for (char c : text) {
+		if (c == '"') quoted += '"';
+		quoted += c;
+	}
+	return quoted + '"';
+}
+
+#define REPORT_CSV_HEADER "name,params,dataset,dataset_size,puzzle_size,puzzles,tests,attempted,solved," \
+	"mean_s,variance_s2,p50_ns,p90_ns,p99_ns,p999_ns,max_ns,hostname,os,compiler,cores,timestamp," \
+	"cycles,instructions,cache_misses,branch_misses,page_faults," \
+	"nodes,backtracks,eliminations,moves_proposed,moves_accepted,reheats,iterations,collapses"
+
+void writeCsvReport(ostream &out, const benchmark_report_t &report) {
+	DEBUG_OUTPUT("writeCsvReport(ostream&, benchmark_report_t&)")
+	const host_info_t &host = report.host;
+	out << setprecision(9) << REPORT_CSV_HEADER << '\n';
+	for (const solver_report_t &solver : report.solvers) {
+		out << csvField(solver.name) << ',' << csvField(solver.params) << ','
+			<< csvField(report.dataset) << ',' << report.datasetSize << ',' << report.puzzleSize << ','
+			<< report.numPuzzles << ',' << solver.tests << ',' << solver.attempted << ',' << solver.solved << ','
+			<< solver.mean << ',' << solver.variance << ','
+			<< solver.p50 << ',' << solver.p90 << ',' << solver.p99 << ',' << solver.p999 << ',' << solver.max << ','
+			<< csvField(host.hostname) << ',' << csvField(host.os) << ',' << csvField(host.compiler) << ','
+			<< host.cores << ',' << host.timestamp;
+		for (unsigned counter = 0; counter < PERF_NUM_COUNTERS; counter++) {
+			out << ',';
+			if (solver.counters.available[counter]) out << solver.counters.values[counter];
+		}
+#ifdef SUDOKU_STATS_ENABLED
+		const solver_stats_t &stats = solver.stats;
+		out << ',' << stats.nodes << ',' << stats.backtracks << ',' << stats.eliminations << ','
+			<< stats.movesProposed << ',' << stats.movesAccepted << ',' << stats.reheats << ','
+			<< stats.iterations << ',' << stats.collapses;
+#else
+		out << ",,,,,,,";
+#endif
+		out << '\n';
+	}
+}
+
+/*******************************************************\
+ * Baseline comparison
+\*******************************************************/
+
+// Splits one csv line, honoring double quoted fields
+static vector<string> splitCsvLine(const string &line) {
+	vector<string> fields(1);
+	bool quoted = false;
+	for (unsigned i = 0; i < line.size(); i++) {
+		char c = line[i];
+		if (quoted) {
+			if (c != '"') fields.back() += c;
+			else if (i + 1 < line.size() && line[i+1] == '"') fields.back() += line[++i];
+			else quoted = false;
+		}
+		else if (c == '"') quoted = true;
+		else if (c == ',') fields.emplace_back();
+		else if (c != '\r') fields.back() += c;
+	}
+	return fields;
+}
+
+bool readCsvReport(const string &filepath, vector<solver_report_t> &solvers) {
+	DEBUG_FUNC_HEADER("readCsvReport(%s, vector<solver_report_t>&)", filepath.c_str())
+	ifstream file(filepath);
+	string line;
+	if (!file.is_open() || !getline(file, line)) {
+		DEBUG_FUNC_RETURN(false)
+		return false;
+	}
+
+	// locate the columns by name, so reports with extra columns still load
+	vector<string> header = splitCsvLine(line);
+	auto column = [&](const char *name) {
+		for (unsigned i = 0; i < header.size(); i++) if (header[i] == name) return static_cast<int>(i);
+		return -1;
+	};
+	int name = column("name"), params = column("params"), tests = column("tests"), attempted = column("attempted"),
+		solved = column("solved"), mean = column("mean_s"), variance = column("variance_s2");
+	if (name < 0 || tests < 0 || attempted < 0 || solved < 0 || mean < 0 || variance < 0) {
+		DEBUG_FUNC_RETURN(false)
+		return false;
+	}
+
+	while (getline(file, line)) {
+		if (line.empty()) continue;
+		vector<string> fields = splitCsvLine(line);
+		if (fields.size() < header.size()) continue;
+		solver_report_t solver = {};
+		solver.name = fields[name];
+		if (params >= 0) solver.params = fields[params];
+		solver.tests = strtoul(fields[tests].c_str(), nullptr, 10);
+		solver.attempted = strtoul(fields[attempted].c_str(), nullptr, 10);
+		solver.solved = strtoul(fields[solved].c_str(), nullptr, 10);
+		solver.mean = strtod(fields[mean].c_str(), nullptr);
+		solver.variance = strtod(fields[variance].c_str(), nullptr);
+		solvers.push_back(solver);
+	}
+	DEBUG_FUNC_RETURN(true)
+	return true;
+}
+
+// Continued fraction of the incomplete beta function (modified Lentz's method)
+static double betaContinuedFraction(double a, double b, double x) {
+	const double tiny = 1e-300;
+	double c = 1, d = 1 - (a + b) * x / (a + 1);
+	if (fabs(d) < tiny) d = tiny;
+	d = 1 / d;
+	double result = d;
+	for (unsigned m = 1; m <= REPORT_BETA_MAX_ITERS; m++) {
+		for (int step = 0; step < 2; step++) {
+			double numerator = step == 0
+				? m * (b - m) * x / ((a + 2*m - 1) * (a + 2*m))
+				: -(a + m) * (a + b + m) * x / ((a + 2*m) * (a + 2*m + 1));
+			d = 1 + numerator * d;
+			if (fabs(d) < tiny) d = tiny;
+			c = 1 + numerator / c;
+			if (fabs(c) < tiny) c = tiny;
+			d = 1 / d;
+			result *= d * c;
+			if (step == 1 && fabs(d * c - 1) < REPORT_BETA_EPSILON) return result;
+		}
+	}
+	return result;
+}
+
+// Regularized incomplete beta function I_x(a, b)
+static double incompleteBeta(double a, double b, double x) {
+	if (x <= 0) return 0;
+	if (x >= 1) return 1;
+	double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1 - x));
+	if (x < (a + 1) / (a + b + 2)) return front * betaContinuedFraction(a, b, x) / a;
+	return 1 - front * betaContinuedFraction(b, a, 1 - x) / b;
+}
+
+// P(T > t) for a student's t distribution with df degrees of freedom
+static double studentUpperTail(double t, double df) {
+	double tail = 0.5 * incompleteBeta(df / 2, 0.5, df / (df + t * t));
+	return t > 0 ? tail : 1 - tail;
+}
+
+unsigned compareWithBaseline(
+	const benchmark_report_t &report,
+	const vector<solver_report_t> &baseline,
+	ostream &out,
+	double alpha
+) {
+	DEBUG_FUNC_HEADER("compareWithBaseline(benchmark_report_t&, vector<solver_report_t>&, ostream&, %f)", alpha)
+	unsigned regressions = 0;
+	out << "\nBaseline comparison (alpha = " << alpha << ")\n";
+	for (const solver_report_t &current : report.solvers) {
+		const solver_report_t *base = nullptr;
+		for (const solver_report_t &candidate : baseline)
+			if (candidate.name == current.name) base = &candidate;
+		if (base == nullptr) {
+			out << "  " << current.name << ": not in baseline\n";
+			continue;
+		}
+		if (!base->params.empty() && base->params != current.params)
+			out << "  " << current.name << ": parameters changed from " << base->params << '\n';
+
+		// Welch's t-test on the mean time per test
+		bool slower = false;
+		double timePValue = 1;
+		double baseError = base->tests > 1 ? base->variance / base->tests : 0;
+		double currentError = current.tests > 1 ? current.variance / current.tests : 0;
+		double error = baseError + currentError;
+		if (base->tests > 1 && current.tests > 1 && error > 0) {
+			double t = (current.mean - base->mean) / sqrt(error);
+			double df = error * error / (baseError * baseError / (base->tests - 1)
+				+ currentError * currentError / (current.tests - 1));
+			timePValue = studentUpperTail(t, df);
+			slower = timePValue < alpha;
+		}
+
+		// two-proportion z-test on the solve rate
+		bool fewerSolves = false;
+		double solvePValue = 1;
+		if (base->attempted && current.attempted) {
+			double baseRate = static_cast<double>(base->solved) / base->attempted;
+			double currentRate = static_cast<double>(current.solved) / current.attempted;
+			double pooled = static_cast<double>(base->solved + current.solved) / (base->attempted + current.attempted);
+			double deviation = sqrt(pooled * (1 - pooled) * (1. / base->attempted + 1. / current.attempted));
+			if (deviation > 0) {
+				solvePValue = 0.5 * erfc((baseRate - currentRate) / deviation / M_SQRT2);
+				fewerSolves = solvePValue < alpha;
+			}
+		}
+
+		double change = base->mean > 0 ? (current.mean / base->mean - 1) * 100 : 0;
+		out << "  " << current.name << ": " << setprecision(5) << base->mean << "s -> " << current.mean << "s ("
+			<< showpos << setprecision(3) << change << noshowpos << "%, p = " << timePValue << "), solved "
+			<< base->solved << '/' << base->attempted << " -> " << current.solved << '/' << current.attempted
+			<< " (p = " << solvePValue << ")";
+		if (slower || fewerSolves) {
+			regressions++;
+			out << " REGRESSION";
+			if (slower) out << " [time]";
+			if (fewerSolves) out << " [solve rate]";
+		}
+		out << '\n';
+	}
+	out << regressions << " regression" << (regressions == 1 ? "" : "s") << " detected\n";
+	DEBUG_FUNC_RETURN(regressions)
+	return regressions;
+}
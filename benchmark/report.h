@@ -0,0 +1,66 @@
+#ifndef SUDOKU_REPORT_H
+#define SUDOKU_REPORT_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "perf_counters.h"
+#include "stats.h"
+
+#define REPORT_DEFAULT_ALPHA 0.01 // significance level of a flagged regression
+
+typedef struct host_info_t {
+    std::string hostname;
+    std::string os;
+    std::string compiler;
+    std::string timestamp; // UTC, ISO 8601
+    unsigned cores;
+
+    static host_info_t collect();
+} host_info_t;
+
+// Results of one solver over every test of a comparison
+typedef struct solver_report_t {
+    std::string name;
+    std::string params; // solver expression given to ADD_SOLVER
+    unsigned tests;
+    unsigned attempted;
+    unsigned solved;
+    double mean; // seconds per test
+    double variance; // seconds^2 per test
+    uint64_t p50, p90, p99, p999, max; // nanoseconds per puzzle
+    perf_sample_t counters; // totals over every test, if collected
+    solver_stats_t stats; // search effort totals over every test, if compiled in
+} solver_report_t;
+
+typedef struct benchmark_report_t {
+    std::string dataset;
+    unsigned long datasetSize;
+    unsigned puzzleSize;
+    unsigned numPuzzles;
+    unsigned numTests;
+    host_info_t host;
+    std::vector<solver_report_t> solvers;
+} benchmark_report_t;
+
+void writeJsonReport(std::ostream &out, const benchmark_report_t &report);
+void writeCsvReport(std::ostream &out, const benchmark_report_t &report);
+
+// Reads the solver rows of a csv report written by writeCsvReport. Returns false
+// if the file cannot be opened or is not a csv report.
+bool readCsvReport(const std::string &filepath, std::vector<solver_report_t> &solvers);
+
+// Compares every solver with the baseline row of the same name, and prints the
+// comparison to out. A solver regressed if its mean time is slower by a one sided
+// Welch's t-test, or its solve rate is lower by a one sided two-proportion z-test,
+// at significance alpha. Returns the number of regressed solvers.
+unsigned compareWithBaseline(
+    const benchmark_report_t &report,
+    const std::vector<solver_report_t> &baseline,
+    std::ostream &out,
+    double alpha = REPORT_DEFAULT_ALPHA
+);
+
+#endif // SUDOKU_REPORT_H
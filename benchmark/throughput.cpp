@@ -0,0 +1,112 @@
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <thread>
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+#include "throughput.h"
+
+using namespace std;
+
+// True if every cell of result and reference hold the same value
+static bool sameValues(const Puzzle &result, const Puzzle &reference) {
+	for (unsigned cell = 0, cellMax = result.getSize() * result.getSize(); cell < cellMax; cell++)
+		if (result.getValue(cell) != reference.getValue(cell)) return false;
+	return true;
+}
+
+// True if result kept every given of original
+static bool keepsGivens(const Puzzle &result, const Puzzle &original) {
+	for (unsigned cell = 0, cellMax = original.getSize() * original.getSize(); cell < cellMax; cell++)
+		if (original.isConcrete(cell) && result.getValue(cell) != original.getValue(cell)) return false;
+	return true;
+}
+
+// Solves a copy of every puzzle in order (or in reverse) with a single solver
+static vector<Puzzle> solveSequentially(const function<Solvers::Solver * ()> &factory, const vector<Puzzle> &pool, bool reverse) {
+	vector<Puzzle> results(pool);
+	unique_ptr<Solvers::Solver> solver(factory());
+	for (unsigned i = 0; i < results.size(); i++)
+		solver->solve(results[reverse ? results.size() - 1 - i : i]);
+	return results;
+}
+
+throughput_result_t measureThroughput(
+	const function<Solvers::Solver * ()> &factory,
+	const vector<Puzzle> &pool,
+	unsigned maxThreads
+) {
+	DEBUG_FUNC_HEADER("measureThroughput(factory, pool[%d], %d)", (int) pool.size(), maxThreads)
+	throughput_result_t result;
+	vector<Puzzle> reference = solveSequentially(factory, pool, false);
+	vector<Puzzle> reversed = solveSequentially(factory, pool, true);
+	result.orderIndependent = true;
+	for (unsigned i = 0; i < pool.size() && result.orderIndependent; i++)
+		result.orderIndependent = sameValues(reference[i], reversed[i]);
+	result.threadSafe = true;
+
+	double singleRate = 0;
+	for (unsigned threads = 1; threads <= maxThreads; threads++) {
+		vector<Puzzle> results(pool);
+		atomic<unsigned> cursor(0);
+
+		// every thread owns its solver, created before the clock starts
+		vector<unique_ptr<Solvers::Solver>> solvers;
+		for (unsigned t = 0; t < threads; t++) solvers.emplace_back(factory());
+		auto work = [&](Solvers::Solver *solver) {
+			for (unsigned i = cursor++; i < results.size(); i = cursor++) solver->solve(results[i]);
+		};
+
+		auto start = chrono::steady_clock::now();
+		vector<thread> workers;
+		for (unsigned t = 1; t < threads; t++) workers.emplace_back(work, solvers[t].get());
+		work(solvers[0].get());
+		for (thread &worker : workers) worker.join();
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		throughput_point_t point = {};
+		point.threads = threads;
+		point.seconds = seconds;
+		point.puzzlesPerSecond = seconds > 0 ? pool.size() / seconds : 0;
+		if (threads == 1) singleRate = point.puzzlesPerSecond;
+		point.efficiency = singleRate > 0 ? point.puzzlesPerSecond / (singleRate * threads) : 0;
+		for (unsigned i = 0; i < pool.size(); i++) {
+			point.solved += results[i].isSolved();
+			point.invalid += !keepsGivens(results[i], pool[i]);
+			point.changed += !sameValues(results[i], reference[i]);
+		}
+		if (point.invalid || (result.orderIndependent && point.changed)) result.threadSafe = false;
+		result.points.push_back(point);
+	}
+	DEBUG_FUNC_END()
+	return result;
+}
+
+void displayThroughput(const string &name, const throughput_result_t &result, ostream &out) {
+	unsigned statwidth = 12;
+	out << '\n' << name << (result.orderIndependent ? "" : " (results depend on puzzle order)") << '\n';
+	out << "|" << setw(8) << "Threads" << " |"
+		<< setw(statwidth) << "Puzzles/s" << " |"
+		<< setw(statwidth) << "Speedup" << " |"
+		<< setw(statwidth) << "Efficiency" << " |"
+		<< setw(statwidth) << "Solved" << " |"
+		<< setw(statwidth) << "Invalid" << " |"
+		<< setw(statwidth) << "Changed" << " |\n";
+	out << '+' << setfill('=') << setw(10) << '+';
+	for (unsigned j = 0; j < 6; j++) out << setw(statwidth+2) << '+';
+	out << setfill(' ') << '\n';
+	double singleRate = result.points.empty() ? 0 : result.points[0].puzzlesPerSecond;
+	for (const throughput_point_t &point : result.points) {
+		out << "|" << setw(8) << point.threads << " |"
+			<< setw(statwidth) << setprecision(6) << point.puzzlesPerSecond << " |"
+			<< setw(statwidth-1) << setprecision(4) << (singleRate > 0 ? point.puzzlesPerSecond / singleRate : 0) << "x |"
+			<< setw(statwidth-1) << point.efficiency * 100 << "% |"
+			<< setw(statwidth) << point.solved << " |"
+			<< setw(statwidth) << point.invalid << " |"
+			<< setw(statwidth) << point.changed << " |\n";
+	}
+	if (!result.threadSafe) out << "WARNING: " << name << " returned different results under threads and may not be thread-safe\n";
+}
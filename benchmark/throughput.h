@@ -0,0 +1,41 @@
+#ifndef SUDOKU_THROUGHPUT_H
+#define SUDOKU_THROUGHPUT_H
+
+#include <functional>
+#include <ostream>
+#include <vector>
+
+#include <puzzle.h>
+#include <solvers.h>
+
+// Throughput of one solver at one thread count
+typedef struct throughput_point_t {
+    unsigned threads;
+    double seconds; // wall time to drain the pool
+    double puzzlesPerSecond;
+    double efficiency; // speedup over one thread, divided by the thread count
+    unsigned solved;
+    unsigned invalid; // results which altered a given
+    unsigned changed; // results which differ from the single threaded reference
+} throughput_point_t;
+
+typedef struct throughput_result_t {
+    std::vector<throughput_point_t> points;
+    bool orderIndependent; // the solver returns the same result for a puzzle regardless of what it solved before
+    bool threadSafe; // no invalid results, and no changed results if the solver is order independent
+} throughput_result_t;
+
+// Drains the puzzle pool with 1..maxThreads threads, each thread pulling puzzles
+// from a shared cursor and solving them with its own solver from factory. Results
+// are validated against two single threaded reference runs over the pool, in
+// order and in reverse: if both agree, the solver does not depend on the order of
+// its puzzles, and any result that changes under threads points to shared state.
+throughput_result_t measureThroughput(
+    const std::function<Solvers::Solver * ()> &factory,
+    const std::vector<Puzzle> &pool,
+    unsigned maxThreads
+);
+
+void displayThroughput(const std::string &name, const throughput_result_t &result, std::ostream &out);
+
+#endif // SUDOKU_THROUGHPUT_H
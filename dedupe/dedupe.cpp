@@ -0,0 +1,106 @@
+// sudoku library
+#include "puzzle.h"
+#include "canonical.h"
+
+// dedupe library
+#include "dedupe.h"
+
+// debugging
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+const char * duplicateKindName(DuplicateKind kind) {
+    switch (kind) {
+        case DuplicateKind::Exact: return "exact";
+        case DuplicateKind::Isomorphic: return "isomorphic";
+    }
+    return "unknown";
+}
+
+uint64_t duplicateKey(const Puzzle &puzzle, DuplicateKind kind) {
+    unsigned char size = puzzle.getSize();
+    unsigned sizeSquared = size * size;
+    unsigned char values[sizeSquared];
+    for (unsigned cell = 0; cell < sizeSquared; cell++) values[cell] = puzzle.getValue(cell);
+    return kind == DuplicateKind::Exact ? canonicalHash(size, values) : canonicalize(size, values).hash;
+}
+
+KeySet::KeySet(size_t expected) : count(0), hasZero(false) {
+    size_t capacity = 16;
+    while (capacity < 2 * expected) capacity <<= 1;
+    slots.assign(capacity, 0);
+}
+
+void KeySet::grow() {
+    DEBUG_OUTPUT("KeySet::grow() to %lu slots", (unsigned long) slots.size() * 2)
+    std::vector<uint64_t> old(slots.size() * 2, 0);
+    old.swap(slots);
+    size_t mask = slots.size() - 1;
+    for (uint64_t key : old) {
+        if (!key) continue;
+        size_t slot = key & mask;
+        while (slots[slot]) slot = (slot + 1) & mask;
+        slots[slot] = key;
+    }
+}
+
+bool KeySet::insert(uint64_t key) {
+    if (!key) {
+        if (hasZero) return false;
+        hasZero = true;
+        count++;
+        return true;
+    }
+    if (2 * (count + 1) > slots.size()) grow();
+    size_t mask = slots.size() - 1, slot = key & mask;
+    while (slots[slot]) {
+        if (slots[slot] == key) return false;
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = key;
+    count++;
+    return true;
+}
+
+DuplicateFinder::DuplicateFinder(DuplicateKind kind, unsigned long expected, size_t memory, 
+    const std::string &tempDirectory, bool forceExternal
+) : kind(kind), external(forceExternal || expected * DEDUPE_SET_BYTES_PER_KEY > memory), 
+    keys(external ? 0 : expected), records(tempDirectory, memory), duplicates(tempDirectory, memory), numDuplicates(0) 
+{
+    DEBUG_OUTPUT("DuplicateFinder(%s, %lu expected, %lu bytes): %s", duplicateKindName(kind), expected, 
+        (unsigned long) memory, external ? "external" : "in memory")
+}
+
+bool DuplicateFinder::add(const Puzzle &puzzle, uint64_t index) {
+    uint64_t key = duplicateKey(puzzle, kind);
+    if (external) {
+        records.push({key, index});
+        return false;
+    }
+    if (keys.insert(key)) return false;
+    numDuplicates++;
+    return true;
+}
+
+void DuplicateFinder::finish() {
+    DEBUG_FUNC_HEADER("DuplicateFinder::finish()")
+    if (!external) {
+        DEBUG_FUNC_END()
+        return;
+    }
+    // records come out grouped by key, first occurrence first
+    records.finish();
+    dedupe_record_t record;
+    uint64_t previous = 0;
+    bool first = true;
+    while (records.next(record)) {
+        if (!first && record.key == previous) {
+            duplicates.push(record.index);
+            numDuplicates++;
+        }
+        previous = record.key;
+        first = false;
+    }
+    duplicates.finish();
+    DEBUG_FUNC_RETURN(numDuplicates)
+}
@@ -0,0 +1,76 @@
+#ifndef SUDOKU_DEDUPE_H
+#define SUDOKU_DEDUPE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "puzzle.h"
+#include "external_sort.h"
+
+#define DEDUPE_DEFAULT_MEMORY (1UL << 30) // bytes of keys held in memory
+#define DEDUPE_SET_BYTES_PER_KEY 16 // slots of 8 bytes, kept at most half full
+
+enum class DuplicateKind { 
+    Exact, // same values
+    Isomorphic // same canonical form
+};
+const char * duplicateKindName(DuplicateKind);
+
+// 64-bit key of a puzzle: the hash of its values, or of its canonical form. Distinct
+// puzzles share a key with probability 2^-64, in which case the later one counts as a
+// duplicate.
+uint64_t duplicateKey(const Puzzle &puzzle, DuplicateKind kind);
+
+// Open addressing set of 64-bit keys with linear probing, which needs no allocation per
+// key. The table doubles whenever it is half full.
+class KeySet {
+    private:
+        std::vector<uint64_t> slots; // zero marks an empty slot, so key zero is kept apart
+        size_t count;
+        bool hasZero;
+        void grow();
+    public:
+        KeySet(size_t expected = 0);
+        // Returns false if the key was already in the set
+        bool insert(uint64_t key);
+        size_t size() const { return count; }
+};
+
+typedef struct dedupe_record_t {
+    uint64_t key;
+    uint64_t index; // line of the puzzle in the dataset, from zero
+    bool operator<(const dedupe_record_t &other) const 
+        { return key < other.key || (key == other.key && index < other.index); }
+} dedupe_record_t;
+
+// Finds the puzzles whose key repeats the key of an earlier puzzle of the dataset. Keys
+// are kept in a KeySet, so duplicates are known as soon as they are added, unless the
+// expected keys would not fit in memory: then (key, index) records are sorted externally,
+// and duplicates are only known after finish, from nextDuplicate.
+class DuplicateFinder {
+    private:
+        const DuplicateKind kind;
+        const bool external;
+        KeySet keys;
+        ExternalSorter<dedupe_record_t> records;
+        ExternalSorter<uint64_t> duplicates; // indices of the duplicates, to remove them in order
+        unsigned long numDuplicates;
+    public:
+        DuplicateFinder(DuplicateKind kind, unsigned long expected, size_t memory, const std::string &tempDirectory, 
+            bool forceExternal = false);
+
+        // Returns true if the puzzle is known to be a duplicate, which is always false when external
+        bool add(const Puzzle &puzzle, uint64_t index);
+        // Ends the dataset. External finders merge their sorted runs to find the duplicates.
+        void finish();
+        // After finish, writes the index of the next duplicate in increasing order (external only)
+        bool nextDuplicate(uint64_t &index) { return duplicates.next(index); }
+
+        DuplicateKind getKind() const { return kind; }
+        bool isExternal() const { return external; }
+        bool isGood() const { return records.isGood() && duplicates.isGood(); }
+        unsigned long getDuplicates() const { return numDuplicates; }
+};
+
+#endif // SUDOKU_DEDUPE_H
@@ -0,0 +1,135 @@
+// standard libraries
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// sudoku library
+#include "puzzle.h"
+#include "data.h"
+
+// dedupe library
+#include "dedupe.h"
+
+using namespace std;
+
+int main(int argc, char **argv) {
+    // -i, --input filepath
+    // -s, --size puzzle_size
+    // -o, --output filepath (written with --remove)
+    // -r, --remove exact|isomorphic
+    // -m, --memory megabytes
+    // --temp directory
+    // --external
+    string input, output, tempDirectory;
+    unsigned char puzzleSize = 9;
+    bool remove = false, forceExternal = false;
+    DuplicateKind removeKind = DuplicateKind::Isomorphic;
+    size_t memory = DEDUPE_DEFAULT_MEMORY;
+
+    // read command flags
+    for (int arg = 1; arg < argc; arg++) {
+        if (!(strcmp(argv[arg], "-i") && strcmp(argv[arg], "--input")) && arg + 1 < argc)
+            input = argv[++arg];
+        else if (!(strcmp(argv[arg], "-s") && strcmp(argv[arg], "--size")) && arg + 1 < argc)
+            puzzleSize = atoi(argv[++arg]);
+        else if (!(strcmp(argv[arg], "-o") && strcmp(argv[arg], "--output")) && arg + 1 < argc)
+            output = argv[++arg];
+        else if (!(strcmp(argv[arg], "-r") && strcmp(argv[arg], "--remove")) && arg + 1 < argc) {
+            remove = true;
+            string kind(argv[++arg]);
+            if (kind == duplicateKindName(DuplicateKind::Exact)) removeKind = DuplicateKind::Exact;
+            else if (kind == duplicateKindName(DuplicateKind::Isomorphic)) removeKind = DuplicateKind::Isomorphic;
+            else {
+                cout << "Unknown duplicate kind: " << kind << " (expected exact or isomorphic)" << endl;
+                return 1;
+            }
+        }
+        else if (!(strcmp(argv[arg], "-m") && strcmp(argv[arg], "--memory")) && arg + 1 < argc)
+            memory = strtoull(argv[++arg], nullptr, 0) << 20;
+        else if (!strcmp(argv[arg], "--temp") && arg + 1 < argc)
+            tempDirectory = argv[++arg];
+        else if (!strcmp(argv[arg], "--external"))
+            forceExternal = true;
+        else {
+            cout << "Unknown flag: " << string(argv[arg]) << endl;
+            cout << "Usage: dedupe -i dataset.csv [-s size] [-r exact|isomorphic -o output.csv] [-m megabytes] "
+                 << "[--temp directory] [--external]" << endl;
+            return 1;
+        }
+    }
+    if (input.empty()) {
+        cout << "No dataset given (-i dataset.csv)" << endl;
+        return 1;
+    }
+    if (remove && output.empty()) {
+        cout << "Removing duplicates needs an output file (-o output.csv)" << endl;
+        return 1;
+    }
+    error_code error;
+    if (tempDirectory.empty()) tempDirectory = filesystem::temp_directory_path(error).string();
+    uintmax_t fileSize = filesystem::file_size(input, error);
+    if (error) {
+        cout << "Could not read " << input << endl;
+        return 1;
+    }
+
+    // lines hold the puzzle and its solution, which bounds the number of puzzles
+    unsigned long expected = fileSize / (2 * puzzleSize * puzzleSize + 2);
+    vector<unique_ptr<DuplicateFinder>> finders;
+    if (remove) finders.emplace_back(new DuplicateFinder(removeKind, expected, memory, tempDirectory, forceExternal));
+    else for (DuplicateKind kind : {DuplicateKind::Exact, DuplicateKind::Isomorphic})
+        finders.emplace_back(new DuplicateFinder(kind, expected, memory / 2, tempDirectory, forceExternal));
+    DuplicateFinder &first = *finders.front();
+
+    // a finder in memory knows duplicates as they stream by, so the output is written in one pass
+    unique_ptr<PuzzleDumper> dumper;
+    if (remove) {
+        dumper.reset(new PuzzleDumper(output, puzzleSize));
+        if (!dumper->good()) {
+            cout << "Could not open " << output << " for writing" << endl;
+            return 1;
+        }
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    PuzzleLoader loader(input, expected, puzzleSize, 0);
+    Puzzle puzzle;
+    uint64_t read = 0;
+    while (loader.next(puzzle)) {
+        bool duplicate = false;
+        for (unique_ptr<DuplicateFinder> &finder : finders) duplicate |= finder->add(puzzle, read);
+        if (remove && !first.isExternal() && !duplicate) dumper->dump(puzzle);
+        read++;
+    }
+    for (unique_ptr<DuplicateFinder> &finder : finders) finder->finish();
+
+    // an external finder lists the duplicates in dataset order, for a second pass
+    if (remove && first.isExternal()) {
+        loader.rewind();
+        uint64_t duplicate, index = 0;
+        bool more = first.nextDuplicate(duplicate);
+        while (loader.next(puzzle)) {
+            if (more && duplicate == index) more = first.nextDuplicate(duplicate);
+            else dumper->dump(puzzle);
+            index++;
+        }
+    }
+    if (dumper) dumper->flush();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Read " << read << " puzzles from " << input << " in " << elapsed << " seconds" << endl;
+    for (unique_ptr<DuplicateFinder> &finder : finders) {
+        cout << "  " << duplicateKindName(finder->getKind()) << " duplicates: " << finder->getDuplicates() 
+             << " (" << (read ? 100. * finder->getDuplicates() / read : 0) << "%, " 
+             << (finder->isExternal() ? "sorted externally" : "in memory") << ")" << endl;
+        if (!finder->isGood()) {
+            cout << "Could not write sorted runs to " << tempDirectory << endl;
+            return 1;
+        }
+    }
+    if (remove) cout << "Wrote " << read - first.getDuplicates() << " puzzles to " << output << endl;
+    return dumper && !dumper->good() ? 1 : 0;
+}
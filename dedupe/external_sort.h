@@ -0,0 +1,97 @@
+#ifndef SUDOKU_EXTERNAL_SORT_H
+#define SUDOKU_EXTERNAL_SORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+
+// Sorts more trivially copyable items than fit in memory. Items are collected in a chunk
+// of at most memory bytes, which is sorted and written to a run file in directory once
+// full. After finish, next merges the runs (and the last chunk) in increasing order.
+// Run files are removed when the sorter is destroyed.
+template <typename T>
+class ExternalSorter {
+    private:
+        typedef std::pair<T, size_t> head_t; // smallest unread item of a run, and the run
+        struct later_t { bool operator()(const head_t &a, const head_t &b) const { return b.first < a.first; } };
+
+        const std::string directory;
+        const size_t chunkCapacity;
+        std::vector<T> chunk;
+        size_t cursor; // next item of the chunk while merging
+        std::vector<std::string> runs;
+        std::vector<std::ifstream> inputs;
+        std::priority_queue<head_t, std::vector<head_t>, later_t> heads;
+        bool good;
+
+        void spill() {
+            std::sort(chunk.begin(), chunk.end());
+            std::string path = directory + "/sudoku_sort_" + std::to_string(reinterpret_cast<uintptr_t>(this)) + "_" +
+                std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "_" + std::to_string(runs.size());
+            std::ofstream run(path, std::ios::binary | std::ios::trunc);
+            run.write(reinterpret_cast<const char *>(chunk.data()), chunk.size() * sizeof(T));
+            good &= run.good();
+            runs.push_back(path);
+            chunk.clear();
+        }
+
+        void pushHead(size_t run) {
+            T item;
+            if (inputs[run].read(reinterpret_cast<char *>(&item), sizeof(T))) heads.emplace(item, run);
+        }
+
+    public:
+        ExternalSorter(const std::string &directory, size_t memory) : directory(directory),
+            chunkCapacity(std::max<size_t>(1, memory / sizeof(T))), cursor(0), good(true) {};
+        ~ExternalSorter() {
+            inputs.clear();
+            for (const std::string &run : runs) std::remove(run.c_str());
+        }
+
+        void push(const T &item) {
+            if (chunk.size() == chunkCapacity) spill();
+            chunk.push_back(item);
+        }
+
+        // Ends the input. Items left in memory are only written if there are runs already.
+        void finish() {
+            if (runs.empty()) {
+                std::sort(chunk.begin(), chunk.end());
+                return;
+            }
+            if (!chunk.empty()) spill();
+            chunk.shrink_to_fit();
+            inputs.resize(runs.size());
+            for (size_t run = 0; run < runs.size(); run++) {
+                inputs[run].open(runs[run], std::ios::binary);
+                pushHead(run);
+            }
+        }
+
+        // Writes the next item in increasing order, returning false once every item was read
+        bool next(T &item) {
+            if (runs.empty()) {
+                if (cursor == chunk.size()) return false;
+                item = chunk[cursor++];
+                return true;
+            }
+            if (heads.empty()) return false;
+            head_t head = heads.top();
+            heads.pop();
+            item = head.first;
+            pushHead(head.second);
+            return true;
+        }
+
+        size_t getRuns() const { return runs.size(); }
+        // false if a run could not be written
+        bool isGood() const { return good; }
+};
+
+#endif // SUDOKU_EXTERNAL_SORT_H
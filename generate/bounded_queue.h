@@ -0,0 +1,52 @@
+#ifndef SUDOKU_BOUNDED_QUEUE_H
+#define SUDOKU_BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Blocking FIFO of at most capacity items between producer and consumer threads.
+// Producers wait while it is full, so a slow consumer bounds the memory in flight.
+// Once closed, pushes fail and pops drain the remaining items before failing.
+template <typename T>
+class BoundedQueue {
+    private:
+        std::mutex mutex;
+        std::condition_variable notFull, notEmpty;
+        std::deque<T> items;
+        const size_t capacity;
+        bool closed;
+    public:
+        BoundedQueue(size_t capacity) : capacity(capacity ? capacity : 1), closed(false) {};
+
+        // Takes the item by swapping it out. Returns false if the queue was closed.
+        bool push(T &item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [&]{ return closed || items.size() < capacity; });
+            if (closed) return false;
+            items.emplace_back();
+            items.back().swap(item);
+            notEmpty.notify_one();
+            return true;
+        }
+
+        // Returns false once the queue is closed and empty
+        bool pop(T &item) {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [&]{ return closed || !items.empty(); });
+            if (items.empty()) return false;
+            item.swap(items.front());
+            items.pop_front();
+            notFull.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            notFull.notify_all();
+            notEmpty.notify_all();
+        }
+};
+
+#endif // SUDOKU_BOUNDED_QUEUE_H
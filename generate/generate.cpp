@@ -1,14 +1,20 @@
 // standard library
 #include <stdlib.h>
+#include <atomic>
+#include <thread>
 #include <vector>
 
 // sudoku library
 #include "puzzle.h"
 #include "solvers.h"
+#include "candidates.h"
+#include "transform.h"
+#include "difficulty.h"
 #include "display.h"
 
 // generate library
 #include "generate.h"
+#include "bounded_queue.h"
 
 // debugging
 // #define DEBUG_ENABLED
@@ -16,73 +22,52 @@
 #include "debugging.h"
 
 
-// Returns true if and only if the provided puzzle has exactly one solution
-bool hasUniqueSolution(Puzzle &&puzzle) {
-    DEBUG_OUTPUT("hasUniqueSolution(Puzzle &&)")
-
-    // Initialize stacktracing vectors
-    unsigned cell = 0, solutionCount = 0;
-    std::vector<unsigned> cells;
-    cells.reserve(puzzle.getSizeSquared());
-    std::vector<unsigned> guesses;
-    guesses.reserve(puzzle.getSizeSquared());
-
-    // Search
-    unsigned char guess = 1;
-    // while (guess <= puzzle.getSize()) {
-    while (true) {
-        if (puzzle.hasConflict() || cell > puzzle.getSizeSquared()) { // branch is invalid or solution was just found
-            // backtrack to the last cell which still has values left to search on this branch
-            guess = puzzle.getSize() + 1;
-            while (guess > puzzle.getSize() && !guesses.empty()) {
-                cell = cells.back();
-                cells.pop_back();
-                guess = guesses.back() + 1;
-                guesses.pop_back();
-                // clear cell
-                puzzle.setValue(cell, 0);
-            }
-            // branch on condition of while loop's termination
-            if (guess <= puzzle.getSize()) { // cell has not been checked for all values
-                puzzle.setValue(cell, guess);
-                cells.push_back(cell);
-                guesses.push_back(guess);
-            } else return solutionCount == 1; // search was exhaustive; return true if one solution was found, else false
-        }
-        else if (!puzzle.isConcrete(cell)) { 
-            // start search for cell at lowest value then progress
-            puzzle.setValue(cell, 1);
-            cells.push_back(cell);
-            guesses.push_back(1);
-        }
-        else if (cell + 1 >= puzzle.getSizeSquared()) 
-            // all cells have been filled in with no conflict found
-            // return false if this is not the first solution found
-            if (++solutionCount > 1) return false; 
+bool hasUniqueSolution(const Puzzle &puzzle) {
+    DEBUG_OUTPUT("hasUniqueSolution(Puzzle &)")
+    return countSolutions(puzzle, 2) == 1;
+}
 
-        cell++;
+unsigned removeClues(unsigned char size, unsigned char *values, const unsigned *order, bool symmetric, 
+    const clue_filter_t &accept
+) {
+    DEBUG_FUNC_HEADER("removeClues(%d, unsigned char*, unsigned*, %s)", size, symmetric ? "true" : "false")
+    unsigned sizeSquared = size * size;
+    CandidateGrid grid(Puzzle(size, values));
+    for (const unsigned *cursor = order, *cursorMax = order + sizeSquared; cursor < cursorMax; cursor++) {
+        unsigned cell = *cursor, mirror = symmetric ? sizeSquared - 1 - cell : cell;
+        if (mirror < cell || values[cell] == 0) continue; // each pair is tried once
+        unsigned char value = values[cell], mirrorValue = values[mirror];
+
+        grid.remove(cell);
+        if (mirror != cell && mirrorValue) grid.remove(mirror);
+        if (grid.countSolutions(2) == 1) {
+            values[cell] = values[mirror] = 0;
+            if (!accept || accept(values)) continue;
+            values[cell] = value;
+            values[mirror] = mirrorValue;
+        }
+        DEBUG_OUTPUT("Keeping the clue at cell %d", cell)
+        grid.place(cell, value);
+        if (mirror != cell && mirrorValue) grid.place(mirror, mirrorValue);
     }
+    DEBUG_FUNC_RETURN(sizeSquared - grid.getNumEmpty())
+    return sizeSquared - grid.getNumEmpty();
 }
 
-class PuzzleInProgress : public Puzzle {
-    public:
-        PuzzleInProgress(unsigned char size, unsigned char *values) {
-            this->initializeSize(size);
-            this->values = values;
-        }
-        bool isConcrete(unsigned cell) const { return false; }
-		bool isConcrete(unsigned char row, unsigned char col) const 
-			{ return false; }
-};
+Difficulty hardestDifficulty(unsigned char size) {
+    return size <= 4 ? Difficulty::Easy : Difficulty::Expert;
+}
 
-void SudokuGenerator::fill(Puzzle *puzzles, unsigned num) {
+bool SudokuGenerator::fill(Puzzle *puzzles, unsigned num) {
     DEBUG_OUTPUT("SudokuGenerator::fill(Puzzle *, %d)", num)
     for (Puzzle *cursor = puzzles, *max = cursor + num; cursor < max; cursor++)
-        *cursor = this->build();
+        if (!this->build(*cursor)) return false;
+    return true;
 }
 
 MarkovAnnealingGenerator::MarkovAnnealingGenerator(unsigned size, unsigned ndims, 
-    double probResample, double probAlter, double probGenerate) : SudokuGenerator(size, ndims) 
+    double probResample, double probAlter, double probGenerate, uint64_t seed) : SudokuGenerator(size, ndims), symmetric(false), 
+    minDifficulty(Difficulty::Easy), maxDifficulty(Difficulty::Expert), random(seed) 
 {
     DEBUG_OUTPUT("MarkovAnnealingGenerator::MarkovAnnealingGenerator(%d, %d, %f, %f, %f)", 
                  size, ndims, probResample, probAlter, probGenerate)
@@ -92,16 +77,10 @@ MarkovAnnealingGenerator::MarkovAnnealingGenerator(unsigned size, unsigned ndims
     this->alterCap = (probResample + probAlter) / sum;
 
     // Intialize annealer
-    this->annealer = new Solvers::GeometricAnnealingSolver(1, 1000, 1000, 0.3);
+    this->annealer = new Solvers::GeometricAnnealingSolver(1, 1000, 1000, 0.3, this->random.next());
 
     // Initialize puzzle state
-    unsigned sizeSquared = size * size;
-    this->state = new unsigned char[sizeSquared];
-    this->preheatIters = size * perfectSqrt(size);
-    for (unsigned char value = 1, *cell = this->state, *max = cell + sizeSquared; cell < max; cell++, value++) {
-        if (value > size) value = 1;
-        *cell = value;
-    }
+    this->state = new unsigned char[size * size];
     this->sampleSolution();
 }
 
@@ -111,48 +90,108 @@ MarkovAnnealingGenerator::~MarkovAnnealingGenerator() {
     delete this->annealer;
 }
 
-Puzzle MarkovAnnealingGenerator::build() {
-    DEBUG_OUTPUT("MarkovAnnealingGenerator::build()")
-    while(true) {
-        double r = std::rand() / static_cast<double>(RAND_MAX);
+bool MarkovAnnealingGenerator::build(Puzzle &puzzle) {
+    DEBUG_OUTPUT("MarkovAnnealingGenerator::build(Puzzle &)")
+    unsigned attempts = 0;
+    while (attempts < GENERATE_MAX_ATTEMPTS) {
+        double r = this->random.uniform();
 
         if (r < this->resampleCap) this->sampleSolution();
         else if (r < this->alterCap) this->alterSolution();
-        else return this->generatePuzzle();
+        else {
+            Puzzle generated = this->generatePuzzle();
+            if (this->minDifficulty == Difficulty::Easy || rateDifficulty(generated).level >= this->minDifficulty) {
+                puzzle = generated;
+                return true;
+            }
+            DEBUG_OUTPUT("Rejecting a puzzle below the %s band", difficultyName(this->minDifficulty))
+            attempts++;
+        }
     }
+    DEBUG_OUTPUT("Giving up after %d puzzles below the %s band", attempts, difficultyName(this->minDifficulty))
+    return false;
 }
 
 void MarkovAnnealingGenerator::sampleSolution() {
     DEBUG_OUTPUT("MarkovAnnealingGenerator::sampleSolution()")
-    // Initial randomization
-    unsigned char *values = this->state;
-    for (unsigned iter = 0; iter < this->preheatIters; iter++) {
-        unsigned char row = std::rand() % this->size;
-        unsigned char col1 = std::rand() % this->size;
-        unsigned char col2 = std::rand() % this->size;
-        std::swap(this->state[COORDS_TO_CELL(row, col1, this->size)], this->state[COORDS_TO_CELL(row, col2, this->size)]);
-    }
-    // Anneal
-    PuzzleInProgress puzzle(this->size, this->state);
-    while(!puzzle.isSolved()) {
-        this->annealer->solve(puzzle);
-    }
+    // Anneal an empty grid until it is filled without conflict. Every row starts
+    // in ascending order, so the grid's randomness comes from the annealer's swaps
+    Puzzle puzzle(this->size);
+    do this->annealer->solve(puzzle); while (this->annealer->getStatus() != SolveStatus::Solved);
+    for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++) this->state[cell] = puzzle.getValue(cell);
 }
 
 void MarkovAnnealingGenerator::alterSolution() {
     DEBUG_OUTPUT("MarkovAnnealingGenerator::alterSolution()")
-    // TODO
+    // jump to a random grid equivalent to the current one, no search needed
+    unsigned sizeSquared = this->size * this->size;
+    unsigned char current[sizeSquared];
+    for (unsigned cell = 0; cell < sizeSquared; cell++) current[cell] = this->state[cell];
+    sudoku_transform_t::random(this->size, this->random).apply(current, this->state);
 }
 
 Puzzle MarkovAnnealingGenerator::generatePuzzle() {
     DEBUG_OUTPUT("MarkovAnnealingGenerator::generatePuzzle()")
     unsigned sizeSquared = this->size * this->size;
-    unsigned char solution[sizeSquared];
-    for (unsigned char *val = this->state, *sol = solution, *solMax = sol + sizeSquared; sol < solMax; val++, sol++)
-        *sol = *val;
-    while (hasUniqueSolution(Puzzle(this->size, this->state))) {
-        unsigned cell = std::rand() % sizeSquared;
-        this->state[cell] = 0;
+    unsigned char values[sizeSquared];
+    unsigned order[sizeSquared];
+    for (unsigned cell = 0; cell < sizeSquared; cell++) {
+        values[cell] = this->state[cell];
+        order[cell] = cell;
+    }
+
+    // try every clue once, in a random order, leaving a minimal puzzle
+    for (unsigned cell = sizeSquared - 1; cell > 0; cell--) std::swap(order[cell], order[this->random.below(cell + 1)]);
+    // puzzles only get harder as clues are cleared, so stop clearing at the top of the band
+    clue_filter_t accept;
+    if (this->maxDifficulty < Difficulty::Expert) {
+        unsigned char size = this->size;
+        Difficulty maxDifficulty = this->maxDifficulty;
+        accept = [size, maxDifficulty](unsigned char *values) {
+            return rateDifficulty(Puzzle(size, values)).level <= maxDifficulty;
+        };
+    }
+    removeClues(this->size, values, order, this->symmetric, accept);
+    return Puzzle(this->size, values, this->state);
+}
+
+unsigned long generateDataset(const generator_factory_t &factory, PuzzleDumper &dumper, unsigned long count, 
+    unsigned threads, unsigned queueCapacity
+) {
+    DEBUG_FUNC_HEADER("generateDataset(factory, dumper, %lu, %d, %d)", count, threads, queueCapacity)
+    if (threads == 0) threads = std::max(1U, std::thread::hardware_concurrency());
+    BoundedQueue<Puzzle> queue(queueCapacity);
+    std::atomic<unsigned long> claimed(0);
+    std::atomic<unsigned> running(threads);
+    std::atomic<bool> failed(false);
+
+    // workers claim puzzles one at a time, the last one to finish closes the queue
+    auto work = [&](unsigned worker) {
+        SudokuGenerator *generator = factory(worker);
+        Puzzle puzzle;
+        while (!failed && claimed++ < count) {
+            if (!generator->build(puzzle)) {
+                failed = true;
+                break;
+            }
+            if (!queue.push(puzzle)) break;
+        }
+        delete generator;
+        if (--running == 0) queue.close();
+    };
+    std::vector<std::thread> workers;
+    for (unsigned worker = 0; worker < threads; worker++) workers.emplace_back(work, worker);
+
+    // the calling thread writes puzzles as they arrive
+    unsigned long dumped = 0;
+    Puzzle puzzle;
+    while (queue.pop(puzzle)) {
+        dumper.dump(puzzle);
+        dumped++;
     }
-    return Puzzle(this->size, this->state, solution);
-}
\ No newline at end of file
+    for (std::thread &worker : workers) worker.join();
+    dumper.flush();
+
+    DEBUG_FUNC_RETURN(dumped)
+    return dumped;
+}
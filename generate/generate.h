@@ -1,8 +1,34 @@
 #ifndef SUDOKU_GENERATE_H
 #define SUDOKU_GENERATE_H
 
+#include <functional>
+
 #include "puzzle.h"
+#include "data.h"
 #include "solvers.h"
+#include "random.h"
+#include "difficulty.h"
+
+#define GENERATE_DEFAULT_QUEUE_CAPACITY 1024 // generated puzzles waiting to be written
+#define GENERATE_MAX_ATTEMPTS 1000 // puzzles rated below the band before a build gives up
+
+// Returns true if and only if the provided puzzle has exactly one solution
+bool hasUniqueSolution(const Puzzle &puzzle);
+
+// Clears the clues of a uniquely solvable grid (e.g. a full solution) in the given
+// order of cells, keeping a clue only if clearing it would allow a second solution.
+// With symmetric set, a cell and its 180 degree rotation are cleared or kept together.
+// One candidate grid is kept across every removal, so each costs a single bounded
+// solution count. Every single cell (or pair) left is then necessary. Returns the
+// number of clues left. If accept is set, a removal keeping the solution unique is
+// also undone when accept rejects the resulting values.
+typedef std::function<bool(unsigned char *values)> clue_filter_t;
+unsigned removeClues(unsigned char size, unsigned char *values, const unsigned *order, bool symmetric = false, 
+    const clue_filter_t &accept = nullptr);
+
+// Hardest level a puzzle of the given size can be rated. Every 4x4 puzzle with a unique
+// solution falls to naked singles alone, so smaller grids are always easy.
+Difficulty hardestDifficulty(unsigned char size);
 
 class SudokuGenerator {
     protected:
@@ -11,27 +37,50 @@ class SudokuGenerator {
     public:
         SudokuGenerator(unsigned size, unsigned ndims) : 
             size(size), ndims(ndims) {};
+        virtual ~SudokuGenerator() = default;
 
-        void fill(Puzzle *puzzles, unsigned num);
-        virtual Puzzle build() = 0;
+        // Returns false if a build gave up, leaving the puzzles after it untouched
+        bool fill(Puzzle *puzzles, unsigned num);
+        // Returns false if no puzzle could be built
+        virtual bool build(Puzzle &puzzle) = 0;
 };
 
-class MarkovAnnealingGenerator : SudokuGenerator {
+class MarkovAnnealingGenerator : public SudokuGenerator {
     private:
         double resampleCap, alterCap;
-        unsigned preheatIters;
+        bool symmetric;
+        Difficulty minDifficulty, maxDifficulty;
         unsigned char *state;
         Solvers::AnnealingSolver * annealer;
+        Random random;
 
         void sampleSolution();
         void alterSolution();
         Puzzle generatePuzzle();
 
     public:
-        Puzzle build() override;
+        // Gives up after GENERATE_MAX_ATTEMPTS puzzles rated below the band
+        bool build(Puzzle &puzzle) override;
+        // Removes clues in symmetric pairs (cell and its 180 degree rotation)
+        void setSymmetric(bool symmetric) { this->symmetric = symmetric; }
+        // Only builds puzzles rated within [min, max]: clearing stops before a puzzle
+        // would rate above max, and puzzles rated below min are discarded
+        void setDifficulty(Difficulty min, Difficulty max) { this->minDifficulty = min; this->maxDifficulty = max; }
 
-        MarkovAnnealingGenerator(unsigned size, unsigned ndims, double probResample, double probAlter, double probGenerate);
+        MarkovAnnealingGenerator(unsigned size, unsigned ndims, double probResample, double probAlter, double probGenerate, 
+            uint64_t seed = RANDOM_DEFAULT_SEED);
         ~MarkovAnnealingGenerator();
 };
 
+// Creates the generator of one worker thread. Generators are never shared, so
+// each must own its random state (e.g. seeded from the worker index).
+typedef std::function<SudokuGenerator *(unsigned worker)> generator_factory_t;
+
+// Builds count puzzles on threads worker threads, each with its own generator,
+// and streams them to dumper through a queue of at most queueCapacity puzzles.
+// The order of the puzzles depends on thread timing. Every worker stops once one of
+// them fails to build a puzzle. Returns the number dumped.
+unsigned long generateDataset(const generator_factory_t &factory, PuzzleDumper &dumper, unsigned long count, 
+    unsigned threads, unsigned queueCapacity = GENERATE_DEFAULT_QUEUE_CAPACITY);
+
 #endif // SUDOKU_GENERATE_H
\ No newline at end of file
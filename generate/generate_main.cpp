@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <iostream>
 #include <string.h>
+#include <chrono>
 
 // sudoku library
 #include "puzzle.h"
@@ -20,10 +21,19 @@ int main(int argc, char **argv) {
     // -pr, --resample-prob resampleP
     // -pa, --alter-prob alterP
     // -pg, --generate-prob generateP
+    // -t, --threads threads
+    // -q, --queue capacity
+    // --symmetric
+    // --difficulty min[:max]
+    // --seed seed
     string filepath;
-    unsigned datasetSize = 1;
+    unsigned long datasetSize = 1;
+    unsigned threads = 0, queueCapacity = GENERATE_DEFAULT_QUEUE_CAPACITY;
+    bool symmetric = false;
+    Difficulty minDifficulty = Difficulty::Easy, maxDifficulty = Difficulty::Expert;
     unsigned char puzzleSize = 9;
     double resampleP = -1, alterP = -1, generateP = -1;
+    unsigned long long seed = RANDOM_DEFAULT_SEED;
 
     // read command flags
     for (unsigned arg = 1; arg < argc; arg++) {
@@ -31,7 +41,7 @@ int main(int argc, char **argv) {
             if (!(strcmp(argv[arg], "-o") && strcmp(argv[arg], "--output")))
                 filepath = string(argv[++arg]);
             else if (!(strcmp(argv[arg], "-n") && strcmp(argv[arg], "--number")))
-                datasetSize = atoi(argv[++arg]);
+                datasetSize = strtoul(argv[++arg], nullptr, 0);
             else if (!(strcmp(argv[arg], "-s") && strcmp(argv[arg], "--size")))
                 puzzleSize = atoi(argv[++arg]);
             else if (!(strcmp(argv[arg], "-pr") && strcmp(argv[arg], "--resample-prob")))
@@ -40,6 +50,24 @@ int main(int argc, char **argv) {
                 alterP = atof(argv[++arg]);
             else if (!(strcmp(argv[arg], "-pg") && strcmp(argv[arg], "--generate-prob")))   
                 generateP = atof(argv[++arg]);
+            else if (!(strcmp(argv[arg], "-t") && strcmp(argv[arg], "--threads")))
+                threads = atoi(argv[++arg]);
+            else if (!(strcmp(argv[arg], "-q") && strcmp(argv[arg], "--queue")))
+                queueCapacity = atoi(argv[++arg]);
+            else if (!strcmp(argv[arg], "--symmetric"))
+                symmetric = true;
+            else if (!strcmp(argv[arg], "--difficulty")) {
+                string band(argv[++arg]);
+                size_t split = band.find(':');
+                minDifficulty = parseDifficulty(band.substr(0, split).c_str());
+                maxDifficulty = split == string::npos ? minDifficulty : parseDifficulty(band.substr(split + 1).c_str());
+                if (minDifficulty == Difficulty::Invalid || maxDifficulty == Difficulty::Invalid || maxDifficulty < minDifficulty) {
+                    cout << "Invalid difficulty band: " << band << " (expected easy, medium, hard or expert, as min[:max])" << endl;
+                    return 1;
+                }
+            }
+            else if (!strcmp(argv[arg], "--seed"))
+                seed = strtoull(argv[++arg], nullptr, 0);
             else {
                 cout << "Unknown flag: " << string(argv[arg]) << endl;
                 return 1;
@@ -48,8 +76,13 @@ int main(int argc, char **argv) {
     }
 
     // process flag settings
-    if (resampleP < 0 && alterP < 0 && generateP < 0)
-        resampleP = alterP = generateP = 1 / 3.;
+    if (resampleP < 0 && alterP < 0 && generateP < 0) {
+        // altering is a cheap transformation while resampling anneals a new grid,
+        // so most steps alter and an occasional resample keeps the grids diverse
+        resampleP = 0.05;
+        alterP = 0.45;
+        generateP = 0.5;
+    }
     else {
         double probsum = (resampleP < 0 ? 0 : resampleP) + (alterP < 0 ? 0 : alterP) + (generateP < 0 ? 0 : generateP);
         unsigned char empties = (resampleP < 0) + (alterP < 0) + (generateP < 0);
@@ -65,15 +98,43 @@ int main(int argc, char **argv) {
         if (alterP < 0) alterP = initVal;
         if (generateP < 0) generateP = initVal;
     } 
+    if (maxDifficulty > hardestDifficulty(puzzleSize)) {
+        cout << "No " << (int) puzzleSize << "x" << (int) puzzleSize << " puzzle rates above " 
+             << difficultyName(hardestDifficulty(puzzleSize)) << endl;
+        return 1;
+    }
     if (filepath.length() == 0) {
         string size = to_string(puzzleSize);
         filepath = size + "x" + size + ".csv";
     }
 
-    cout << "Generating Puzzle" << endl;
-    Puzzle puzzle = MarkovAnnealingGenerator(puzzleSize, 2, resampleP, alterP, generateP).build();
-    cout << "Dumping Puzzle" << endl;
-    PuzzleDumper("../test.csv", puzzleSize).dump(puzzle);
+    PuzzleDumper dumper(filepath, puzzleSize);
+    if (!dumper.good()) {
+        cout << "Could not open " << filepath << " for writing" << endl;
+        return 1;
+    }
+
+    // every worker gets its own generator, seeded from the base seed and its index
+    generator_factory_t factory = [&](unsigned worker) -> SudokuGenerator* {
+        uint64_t workerSeed = seed + worker;
+        MarkovAnnealingGenerator *generator = 
+            new MarkovAnnealingGenerator(puzzleSize, 2, resampleP, alterP, generateP, splitmix64(workerSeed));
+        generator->setSymmetric(symmetric);
+        generator->setDifficulty(minDifficulty, maxDifficulty);
+        return generator;
+    };
+
+    cout << "Generating " << datasetSize << " puzzles into " << filepath << endl;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    unsigned long generated = generateDataset(factory, dumper, datasetSize, threads, queueCapacity);
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Generated " << generated << " puzzles in " << elapsed << " seconds (" 
+         << generated / elapsed << " puzzles per second)" << endl;
+    if (generated < datasetSize) {
+        cout << "Gave up after " << GENERATE_MAX_ATTEMPTS << " puzzles below the " << difficultyName(minDifficulty) 
+             << " band" << endl;
+        return 1;
+    }
 
-    return 0;
+    return dumper.good() ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef SUDOKU_BUDGET_H
+#define SUDOKU_BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#define SOLVE_CHECK_INTERVAL 1024 // units of work between clock and cancellation checks
+
+// Reason a solve stopped
+enum class SolveStatus {
+    Running,
+    Solved,
+    Unsolvable, // the search space was exhausted, so there is no solution
+    Unsolved, // a heuristic gave up without proving there is no solution
+    BudgetExhausted,
+    TimedOut,
+    Cancelled
+};
+const char * solveStatusName(SolveStatus);
+
+// Flag shared with running solves, which stop at their next check once it is set.
+// The token may be cancelled from any thread. A token chained to a parent also
+// reads as cancelled once the parent is.
+class CancellationToken {
+    private:
+        std::atomic<bool> cancelled;
+        const CancellationToken *parent; // not owned
+    public:
+        CancellationToken(const CancellationToken *parent = nullptr) : cancelled(false), parent(parent) {};
+        void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+        void reset() { cancelled.store(false, std::memory_order_relaxed); }
+        bool isCancelled() const
+            { return cancelled.load(std::memory_order_relaxed) || (parent && parent->isCancelled()); }
+};
+
+// Limits of a single solve. The defaults leave the solve unbounded.
+typedef struct solve_options_t {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    uint64_t budget = 0; // units of work (search nodes, annealing proposals, graph iterations), 0 is unbounded
+    const CancellationToken *cancellation = nullptr; // not owned, must outlive the solve
+
+    // Sets the deadline to timeout from now
+    solve_options_t &timeout(std::chrono::nanoseconds timeout)
+        { deadline = std::chrono::steady_clock::now() + timeout; return *this; }
+    bool isBounded() const
+        { return budget || cancellation || deadline != std::chrono::steady_clock::time_point::max(); }
+} solve_options_t;
+
+// Work counter of a solve in progress, polled from the solver's main loop. Work is
+// charged with spend, which only reads the clock and the token every
+// SOLVE_CHECK_INTERVAL units, so an unbounded solve pays one addition and one
+// comparison per unit.
+typedef struct solve_budget_t {
+    const solve_options_t options;
+    uint64_t spent;
+    uint64_t nextCheck; // spent at which the limits are checked next
+    SolveStatus status; // Running until a limit is reached
+
+    solve_budget_t(const solve_options_t &options) : options(options), spent(0), status(SolveStatus::Running)
+        { nextCheck = options.isBounded() ? 0 : UINT64_MAX; }
+
+    // Charges count units of work, returning true once the solve must stop
+    bool spend(uint64_t count = 1) {
+        spent += count;
+        return spent >= nextCheck && check();
+    }
+    // Charges count units of work and checks every limit now, for loops with coarse steps
+    bool spendAndCheck(uint64_t count) {
+        spent += count;
+        return options.isBounded() && check();
+    }
+    // Checks every limit, returning true once the solve must stop
+    bool check() {
+        nextCheck = spent + SOLVE_CHECK_INTERVAL;
+        if (options.budget && nextCheck > options.budget) nextCheck = options.budget;
+        if (options.budget && spent >= options.budget) status = SolveStatus::BudgetExhausted;
+        else if (options.cancellation && options.cancellation->isCancelled()) status = SolveStatus::Cancelled;
+        else if (std::chrono::steady_clock::now() >= options.deadline) status = SolveStatus::TimedOut;
+        return stopped();
+    }
+    bool stopped() const { return status != SolveStatus::Running; }
+} solve_budget_t;
+
+#endif // SUDOKU_BUDGET_H
@@ -0,0 +1,54 @@
+#ifndef SUDOKU_CACHE_H
+#define SUDOKU_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "canonical.h"
+
+#define CACHE_DEFAULT_CAPACITY 65536 // canonical solutions kept
+#define CACHE_DEFAULT_SHARDS 16
+
+// Bounded map from canonical puzzles to their canonical solutions, evicting the least
+// recently used entry. Entries are spread over shards by hash, each with its own lock
+// and its own share of the capacity, so concurrent solvers rarely wait on each other.
+class SolutionCache {
+	private:
+		typedef struct cache_entry_t {
+			uint64_t hash;
+			std::vector<unsigned char> puzzle, solution;
+		} cache_entry_t;
+		typedef struct cache_shard_t {
+			std::mutex mutex;
+			std::list<cache_entry_t> entries; // most recently used first
+			std::unordered_map<uint64_t, std::list<cache_entry_t>::iterator> index;
+		} cache_shard_t;
+
+		std::unique_ptr<cache_shard_t[]> shards;
+		const unsigned numShards;
+		const size_t shardCapacity;
+		std::atomic<unsigned long> hits, misses;
+
+		cache_shard_t &shardOf(uint64_t hash) { return shards[(hash >> 32) % numShards]; }
+
+	public:
+		SolutionCache(size_t capacity = CACHE_DEFAULT_CAPACITY, unsigned shards = CACHE_DEFAULT_SHARDS);
+
+		// Writes the canonical solution of the canonical puzzle to solution, returning false
+		// if it is not cached. A puzzle sharing the hash of a cached one is a miss.
+		bool lookup(const canonical_form_t &puzzle, unsigned char *solution);
+		// Caches the canonical solution (the puzzle's solution under puzzle.transform)
+		void insert(const canonical_form_t &puzzle, const unsigned char *solution);
+		void clear();
+
+		unsigned long getHits() const { return hits; }
+		unsigned long getMisses() const { return misses; }
+		size_t size();
+};
+
+#endif // SUDOKU_CACHE_H
@@ -0,0 +1,93 @@
+#ifndef SUDOKU_CANDIDATES_H
+#define SUDOKU_CANDIDATES_H
+
+#include <vector>
+
+#include "puzzle.h"
+#include "budget.h"
+
+#define CANDIDATE_BIT(value) (1U << ((value) - 1))
+
+// Tracks the values used in every row, column and box of a puzzle so that
+// the candidates of a cell can be read as a bitmask: bit (value - 1) is set
+// if value can be placed in the cell without creating a conflict.
+class CandidateGrid {
+	protected:
+		unsigned char sizeSqrt;
+		unsigned char size;
+		unsigned sizeSquared;
+		unsigned fullMask;
+		unsigned numEmpty;
+		bool consistent;
+
+		unsigned char *values;
+		unsigned char *rowOf, *colOf, *boxOf; // unit indices of every cell
+		unsigned *rowUsed, *colUsed, *boxUsed; // bitmask of values used in every unit
+		unsigned ***units; // cells of every row, column and box (shared, from graphNeighborhoods)
+
+		void initializeSize(unsigned char size);
+
+	public:
+		// Builds the grid from the puzzle's values, or only its concrete values if givensOnly is set
+		CandidateGrid(const Puzzle &puzzle, bool givensOnly = false);
+		CandidateGrid(const CandidateGrid &other);
+		~CandidateGrid();
+
+		// Accessors
+		unsigned char getSize() const {return size;}
+		unsigned getSizeSquared() const {return sizeSquared;}
+		unsigned getNumEmpty() const {return numEmpty;}
+		unsigned char getValue(unsigned cell) const {return values[cell];}
+		const unsigned char * getValues() const {return values;}
+		bool isConsistent() const {return consistent;}
+		unsigned candidates(unsigned cell) const
+			{ return fullMask & ~(rowUsed[rowOf[cell]] | colUsed[colOf[cell]] | boxUsed[boxOf[cell]]); }
+
+		// Mutators: place expects an empty cell and a candidate value
+		void place(unsigned cell, unsigned char value);
+		void remove(unsigned cell);
+
+		// Returns the empty cell with the fewest candidates (writing them to mask),
+		// or sizeSquared if every cell is filled
+		unsigned findMostConstrained(unsigned &mask) const;
+
+		// Places naked singles (cells with one candidate) and hidden singles (values with
+		// one possible cell in a row, column or box) until none remain, appending every
+		// placed cell to placed. Returns false once a cell or a unit value has no options.
+		bool propagate(std::vector<unsigned> &placed);
+		// Counts solutions up to limit, propagating singles before every branch on the
+		// most constrained cell. The grid is returned to its initial state.
+		unsigned countSolutions(unsigned limit);
+};
+
+// Number of solutions of the puzzle, counting stops at limit (2 decides uniqueness)
+unsigned countSolutions(const Puzzle &puzzle, unsigned limit);
+
+// Exhaustive depth-first search over a CandidateGrid, branching on the most
+// constrained cell. The grid is returned to its initial state after a search.
+class CandidateSearch {
+	protected:
+		CandidateGrid &grid;
+		solve_budget_t *budget; // charged one unit per node, if set
+
+		// Chooses which of the remaining candidate values of a cell to try next
+		virtual unsigned char nextValue(unsigned /*cell*/, unsigned remaining)
+			{ return __builtin_ctz(remaining) + 1; }
+
+	public:
+		unsigned long nodes;
+		unsigned long backtracks;
+		unsigned long eliminations; // candidates ruled out at branching cells
+
+		CandidateSearch(CandidateGrid &grid) : grid(grid), budget(nullptr), nodes(0), backtracks(0), eliminations(0) {};
+		virtual ~CandidateSearch() = default;
+
+		// Stops searches once budget runs out, leaving the reason in budget->status
+		void limit(solve_budget_t *budget) { this->budget = budget; }
+
+		// Searches until limit solutions are found or the search space is exhausted.
+		// Returns the number of solutions found, writing the first one to solution if provided.
+		unsigned search(unsigned limit, unsigned char *solution = nullptr);
+};
+
+#endif // SUDOKU_CANDIDATES_H
@@ -0,0 +1,36 @@
+#ifndef SUDOKU_CANONICAL_H
+#define SUDOKU_CANONICAL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "transform.h"
+
+#define CANONICAL_MAX_SQRT 5 // larger grids are their own canonical form
+#define CANONICAL_MAX_SIZE (CANONICAL_MAX_SQRT * CANONICAL_MAX_SQRT)
+#define CANONICAL_MAX_NODES 10000 // row choices explored before settling for the best form found
+
+// The representative of a puzzle among every grid reachable by the validity-preserving
+// transformations: the lexicographically smallest grid (row by row, empty cells first)
+// whose digits are numbered in order of first appearance.
+typedef struct canonical_form_t {
+	sudoku_transform_t transform; // maps the puzzle to values
+	std::vector<unsigned char> values;
+	uint64_t hash; // of values
+
+	bool operator==(const canonical_form_t &other) const { return hash == other.hash && values == other.values; }
+} canonical_form_t;
+
+// Finds the canonical form by branch and bound, placing rows one at a time in both
+// orientations. The column order is refined lazily: each row takes the smallest values
+// the order fixed by earlier rows allows, so only ties branch, and a row larger than the
+// same row of the best grid found is cut. The column orders of a row of new digits count
+// as one row choice. A search exceeding CANONICAL_MAX_NODES (or a puzzle with conflicts)
+// keeps the best grid found, so isomorphic puzzles may then map to different forms.
+// Either way, the transform is always valid.
+canonical_form_t canonicalize(unsigned char size, const unsigned char *values);
+
+// 64-bit FNV-1a hash of size * size values, finalized with the splitmix64 mixer
+uint64_t canonicalHash(unsigned char size, const unsigned char *values);
+
+#endif // SUDOKU_CANONICAL_H
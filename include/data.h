@@ -4,8 +4,8 @@
 #include <string>
 #include <fstream>
 #include "puzzle.h"
+#include "random.h"
 
-#define RAND_MAX_LOWER_BOUND_FACTOR 10 // 10*DATASET_SIZE to ensure biggest uniform pmf discrepancy is 11:10
 #define SUDOKU_DATASET_HEADER_LINESIZE 15 // Puzzle,Solution
 
 class PuzzleLoader {
@@ -16,10 +16,13 @@ class PuzzleLoader {
         const unsigned puzzleSizeSquared;
         unsigned lineSize;
         unsigned headerSize;
-        unsigned randMultiplier;
         unsigned seed;
+        Random random;
         unsigned batchSize;
         unsigned puzzleCursor;
+        std::ifstream stream; // open while streaming with next
+
+        Puzzle parse(const std::string &line) const;
 
     public:
         PuzzleLoader(std::string filepath, unsigned long datasetSize, unsigned char puzzleSize) : 
@@ -28,25 +31,45 @@ class PuzzleLoader {
 
         // void batch(unsigned batchSize) { this->batchSize = batchSize; }
 
-        // Puzzle * next();
+        // Streams the file from the start, keeping it open between calls, and returns false
+        // once every line was read. Unlike load, this needs no dataset size.
+        bool next(Puzzle &puzzle);
+        // Restarts streaming at the first puzzle
+        void rewind() { stream.close(); }
 
+        // Loads the puzzle selected by seed, or the next puzzle if seed is zero
         Puzzle load(unsigned seed);
-        inline Puzzle load() { return load(0); }
+        // Loads a random puzzle if the loader was seeded, otherwise the next puzzle in the file
+        Puzzle load();
+
+        const std::string &getFile() const { return file; }
+        unsigned long getDatasetSize() const { return datasetSize; }
+        unsigned char getPuzzleSize() const { return puzzleSize; }
+        unsigned getSeed() const { return seed; }
 };
 
+#define SUDOKU_DUMPER_BUFFER_SIZE (1 << 16) // bytes of csv lines held before writing
+
+// Writes puzzles to a csv file in the format PuzzleLoader reads. The file stays
+// open, and lines are batched in memory and written once the buffer fills, on
+// flush, and when the dumper is destroyed.
 class PuzzleDumper {
     private:
         const std::string filepath;
         const unsigned char puzzleSize;
-        unsigned char digits;
         std::ofstream file;
+        std::string buffer;
 
         void startFile();
     public:
         PuzzleDumper(std::string filepath, unsigned char puzzleSize);
+        ~PuzzleDumper() { flush(); }
 
         void dump(const Puzzle &puzzle);
         void dump(const Puzzle *puzzle, unsigned num);
+        void flush();
+        // false if the file could not be opened or a write failed
+        bool good() const { return file.good(); }
 };
 
 #endif
\ No newline at end of file
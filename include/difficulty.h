@@ -0,0 +1,36 @@
+#ifndef SUDOKU_DIFFICULTY_H
+#define SUDOKU_DIFFICULTY_H
+
+#include "puzzle.h"
+#include "stats.h"
+
+#define DIFFICULTY_EXPERT_BACKTRACKS 256 // search backtracks beyond which a puzzle is expert
+#define DIFFICULTY_HIDDEN_SINGLE_WEIGHT 2.
+#define DIFFICULTY_NODE_WEIGHT 10.
+#define DIFFICULTY_BACKTRACK_WEIGHT 20.
+
+// Ordered from easiest to hardest
+enum class Difficulty {
+    Easy, // naked singles alone solve the puzzle
+    Medium, // hidden singles are needed as well
+    Hard, // singles stall and a short search is needed
+    Expert, // the search needs more than DIFFICULTY_EXPERT_BACKTRACKS backtracks
+    Invalid // no solution, or more than one
+};
+const char * difficultyName(Difficulty);
+// Parses a difficulty name, returning Invalid if it is unknown
+Difficulty parseDifficulty(const char *name);
+
+typedef struct difficulty_t {
+    Difficulty level;
+    unsigned nakedSingles; // cells placed as the only candidate of the cell
+    unsigned hiddenSingles; // cells placed as the only cell for a value in a row, column or box
+    solver_stats_t search; // nodes, backtracks and eliminations of the search after the singles stall
+    double score; // weighted sum of the techniques and search effort, comparable across puzzles
+} difficulty_t;
+
+// Rates a puzzle the way a person would solve it: naked singles whenever there
+// are any, hidden singles otherwise, and a candidate search once both stall.
+difficulty_t rateDifficulty(const Puzzle &puzzle);
+
+#endif // SUDOKU_DIFFICULTY_H
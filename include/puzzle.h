@@ -47,17 +47,20 @@ class Puzzle {
 			{return values[COORDS_TO_CELL(row, col, size)];}
 		unsigned char getValue(unsigned cell) const
 			{return values[cell];}
+		const unsigned char * getValues() const {return values;}
 		unsigned char getSolutionAt(unsigned char row, unsigned char col) const
 			{return solution[COORDS_TO_CELL(row, col, size)];}
 		unsigned char getSolutionAt(unsigned cell) const
 			{return solution[cell];}
 		unsigned char getSize() const {return size;}
 		unsigned char getSizeSqrt() const {return sizeSqrt;}
-		unsigned char getSizeSquared() const {return sizeSquared;}
+		unsigned getSizeSquared() const {return sizeSquared;}
 
 		// Mutators
 		bool setValue(unsigned char row, unsigned char col, unsigned char val) { return setValue(COORDS_TO_CELL(row, col, size), val); }
-		bool setValue(unsigned cell, unsigned char val);
+		bool setValue(unsigned cell, unsigned char val); // rejects concrete cells and out of range cells or values
+		// Solver fast path: the caller guarantees the cell is in range and not concrete, and the value is at most size
+		void setValueUnchecked(unsigned cell, unsigned char val) {values[cell] = val;}
 		bool setSolution(unsigned char* solution, bool copy = true);
 		void reset();
 
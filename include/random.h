@@ -0,0 +1,71 @@
+#ifndef SUDOKU_RANDOM_H
+#define SUDOKU_RANDOM_H
+
+#include <cstdint>
+
+#define RANDOM_DEFAULT_SEED 0x5EED5EED5EED5EEDULL
+
+// Expands a seed into well-mixed state words (Steele, Lea & Flood's splitmix64)
+inline uint64_t splitmix64(uint64_t &state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256** (Blackman & Vigna)
+class Xoshiro256 {
+    private:
+        uint64_t state[4];
+        static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    public:
+        Xoshiro256(uint64_t seed = RANDOM_DEFAULT_SEED) { this->seed(seed); }
+        void seed(uint64_t seed) { for (uint64_t *word = state; word < state + 4; word++) *word = splitmix64(seed); }
+        uint64_t next() {
+            uint64_t result = rotl(state[1] * 5, 7) * 9, t = state[1] << 17;
+            state[2] ^= state[0]; state[3] ^= state[1];
+            state[1] ^= state[2]; state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 45);
+            return result;
+        }
+};
+
+// PCG-XSH-RR with 64-bit state and 32-bit output (O'Neill), widened to 64 bits per call
+class Pcg32 {
+    private:
+        uint64_t state, increment;
+        uint32_t next32() {
+            uint64_t old = state;
+            state = old * 6364136223846793005ULL + increment;
+            uint32_t shifted = ((old >> 18) ^ old) >> 27, rot = old >> 59;
+            return (shifted >> rot) | (shifted << ((-rot) & 31));
+        }
+    public:
+        Pcg32(uint64_t seed = RANDOM_DEFAULT_SEED) { this->seed(seed); }
+        void seed(uint64_t seed) { state = splitmix64(seed); increment = splitmix64(seed) | 1; next32(); }
+        uint64_t next() { return (static_cast<uint64_t>(next32()) << 32) | next32(); }
+};
+
+// Random number generator owned by a single solver, generator or loader. It is
+// never shared, so there is no locking, and a fixed seed reproduces a run exactly.
+// Define SUDOKU_RANDOM_PCG to build with the PCG engine instead of xoshiro.
+template <typename Engine>
+class RandomSource : public Engine {
+    public:
+        RandomSource(uint64_t seed = RANDOM_DEFAULT_SEED) : Engine(seed) {};
+
+        // uniform integer in [0, bound) by multiply-shift (Lemire), bias below bound / 2^64
+        uint64_t below(uint64_t bound)
+            { return static_cast<uint64_t>((static_cast<unsigned __int128>(this->next()) * bound) >> 64); }
+        // uniform double in [0, 1)
+        double uniform() { return (this->next() >> 11) * 0x1.0p-53; }
+};
+
+#ifdef SUDOKU_RANDOM_PCG
+typedef RandomSource<Pcg32> Random;
+#else
+typedef RandomSource<Xoshiro256> Random;
+#endif
+
+#endif // SUDOKU_RANDOM_H
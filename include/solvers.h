@@ -1,53 +1,183 @@
 #ifndef SUDOKU_SOLVER_BASIC_H
 #define SUDOKU_SOLVER_BASIC_H
 
+#include <map>
+#include <memory>
+#include <vector>
+
 #include "puzzle.h"
+#include "random.h"
+#include "budget.h"
+#include "cache.h"
+#include "stats.h"
+#include "trace.h"
 
 #define SOLVER_BODY : Solver { \
     public: \
+        using Solver::solve; \
         void solve(Puzzle&) override; \
 };
 
 namespace Solvers {
 
+// Outcome of one solve, filled in by the solver as it stops
+typedef struct solve_result_t {
+    SolveStatus status;
+    const unsigned char *values; // the puzzle's values (size * size), valid while the puzzle is unchanged
+    solver_stats_t stats; // effort of this solve alone
+    uint64_t elapsed; // nanoseconds
+
+    bool isSolved() const { return status == SolveStatus::Solved; }
+} solve_result_t;
+
+// Solvers fill in the puzzle in place. Every solve sets status, and polls a solve_budget_t
+// built from options in its main loop so that bounded solves stop early; outside a call
+// to solve(Puzzle&, const solve_options_t&), options are unbounded. The status tells
+// callers whether the puzzle was solved without scanning the grid again.
 class Solver {
+    protected:
+        solver_stats_t stats; // accumulated over every solve since the last resetStats
+        solve_options_t options; // limits of the solve in progress
+        SolveStatus status = SolveStatus::Running; // of the last solve
     public: 
+        virtual ~Solver() = default;
         virtual void solve(Puzzle&) = 0;
+        // Solves within the limits of options (pass solve_options_t() for none), returning
+        // why the solve stopped with its effort and time. A stopped solve leaves the puzzle
+        // partially filled.
+        solve_result_t solve(Puzzle &puzzle, const solve_options_t &options);
+        // Solves count puzzles, writing the status of each to statuses if given. Solvers which
+        // share work between puzzles override this; the default solves them one at a time.
+        virtual void solveBatch(Puzzle *puzzles, unsigned count, SolveStatus *statuses = nullptr);
+        SolveStatus getStatus() const { return status; }
+        const solver_stats_t &getStats() const { return stats; }
+        void resetStats() { stats = solver_stats_t(); }
         Puzzle solveCopy(const Puzzle &puzzle) 
             {Puzzle newPuzzle(puzzle); solve(newPuzzle); return newPuzzle;}
 };
 
 class DepthFirstSolverV1 : public virtual Solver 
-    { public: void solve(Puzzle&) override; };
+    { public: using Solver::solve; void solve(Puzzle&) override; };
 class DepthFirstSolver : public virtual Solver 
-    { public: void solve(Puzzle&) override; };
+    { public: using Solver::solve; void solve(Puzzle&) override; };
 
+// Simulated annealing over row swaps. Subclasses define the cooling schedule by
+// implementing tempSchedule, which is called before every markov chain with the 
+// chain's index and the previous temperature. An initial temperature of zero (or 
+// less) in any of the schedules below is replaced by a temperature calibrated 
+// from sampled swaps of the puzzle being solved.
 class AnnealingSolver : public virtual Solver {
     protected:
-        unsigned iterations;
+        unsigned iterations; // markov chains per heat
         unsigned reheats;
+        Random random;
+        double acceptanceRate; // fraction of proposed swaps accepted in the last chain
+        double calibratedTemp; // temperature at which most worsening swaps are accepted
+        double chainAcceptFraction; // chains end once this fraction of their proposals were accepted
+
+        double initialTemperature(double tempInit) const { return tempInit > 0 ? tempInit : calibratedTemp; }
     public:
-        AnnealingSolver(unsigned reheats, unsigned iterations);
+        AnnealingSolver(unsigned reheats, unsigned iterations, uint64_t seed = RANDOM_DEFAULT_SEED);
+        void seed(uint64_t seed) { random.seed(seed); }
+        // Adaptive chain length: end each chain early after acceptFraction * chainLength accepted swaps
+        void setChainAcceptFraction(double acceptFraction) { chainAcceptFraction = acceptFraction; }
+        using Solver::solve;
         void solve(Puzzle&) override;
-        virtual double tempSchedule(unsigned iteration, double temperature) = 0;
+        virtual double tempSchedule(unsigned chain, double temperature) = 0;
 };
+// t = a * t
 class GeometricAnnealingSolver : public virtual AnnealingSolver {
     private:
         double tempInit, tempFact;
     public: 
-        GeometricAnnealingSolver(unsigned reheats, unsigned iterations, double initialTemp, double tempFactor) :
-            AnnealingSolver(reheats, iterations), tempInit(initialTemp), tempFact(tempFactor) {};
-        double tempSchedule(unsigned iteration, double temperature) override;
+        GeometricAnnealingSolver(unsigned reheats, unsigned iterations, double initialTemp, double tempFactor, 
+            uint64_t seed = RANDOM_DEFAULT_SEED) :
+            AnnealingSolver(reheats, iterations, seed), tempInit(initialTemp), tempFact(tempFactor) {};
+        double tempSchedule(unsigned chain, double temperature) override;
+};
+// t falls in equal steps from the initial to the final temperature over a heat
+class LinearAnnealingSolver : public virtual AnnealingSolver {
+    private:
+        double tempInit, tempFinal;
+    public: 
+        LinearAnnealingSolver(unsigned reheats, unsigned iterations, double initialTemp, double finalTemp, 
+            uint64_t seed = RANDOM_DEFAULT_SEED) :
+            AnnealingSolver(reheats, iterations, seed), tempInit(initialTemp), tempFinal(finalTemp) {};
+        double tempSchedule(unsigned chain, double temperature) override;
+};
+// t = t0 * ln(2) / ln(k + 2) for the kth chain
+class LogarithmicAnnealingSolver : public virtual AnnealingSolver {
+    private:
+        double tempInit;
+    public: 
+        LogarithmicAnnealingSolver(unsigned reheats, unsigned iterations, double initialTemp, 
+            uint64_t seed = RANDOM_DEFAULT_SEED) :
+            AnnealingSolver(reheats, iterations, seed), tempInit(initialTemp) {};
+        double tempSchedule(unsigned chain, double temperature) override;
+};
+// t = t / (1 + b * t)
+class LundyMeesAnnealingSolver : public virtual AnnealingSolver {
+    private:
+        double tempInit, beta;
+    public: 
+        LundyMeesAnnealingSolver(unsigned reheats, unsigned iterations, double initialTemp, double beta, 
+            uint64_t seed = RANDOM_DEFAULT_SEED) :
+            AnnealingSolver(reheats, iterations, seed), tempInit(initialTemp), beta(beta) {};
+        double tempSchedule(unsigned chain, double temperature) override;
+};
+// Steers t so the acceptance rate of each chain tracks a target rate, which 
+// decays geometrically by targetDecay per chain: t = t * exp(g * (target - rate))
+class AdaptiveAnnealingSolver : public virtual AnnealingSolver {
+    private:
+        double tempInit, targetInit, targetDecay, target;
+    public: 
+        AdaptiveAnnealingSolver(unsigned reheats, unsigned iterations, double initialTemp, double targetAcceptance, 
+            double targetDecay, uint64_t seed = RANDOM_DEFAULT_SEED) :
+            AnnealingSolver(reheats, iterations, seed), tempInit(initialTemp), 
+            targetInit(targetAcceptance), targetDecay(targetDecay), target(targetAcceptance) {};
+        double tempSchedule(unsigned chain, double temperature) override;
 };
 
+// Runs one annealing replica per temperature on separate threads. The temperatures
+// form a ladder following the geometric schedule (tempSchedule(k) for the kth 
+// replica), and every exchangeInterval chains, replicas at neighboring temperatures
+// swap places with the Metropolis exchange probability. Zero replicas uses every core.
+class ParallelTemperingSolver : public virtual GeometricAnnealingSolver {
+    private:
+        unsigned replicas;
+        unsigned exchangeInterval;
+    public:
+        ParallelTemperingSolver(unsigned replicas, unsigned iterations, double initialTemp, double tempFactor,
+            unsigned exchangeInterval = 1, uint64_t seed = RANDOM_DEFAULT_SEED);
+        using Solver::solve;
+        void solve(Puzzle&) override;
+};
+
+// Reason the last graph collapse stopped iterating
+enum class GraphTermination { 
+    Running, 
+    Solved, 
+    Converged, // coordinates reached a fixed point
+    Oscillating, // coordinates revisited a recent state
+    Stagnated, // no cell collapsed, and the coordinates barely moved, within the stagnation window
+    IterationLimit 
+};
+const char * graphTerminationName(GraphTermination);
+
 class GraphSolver : public virtual Solver {
-    protected: const unsigned maxIters;
+    protected: 
+        const unsigned maxIters;
+        GraphTermination termination;
+        unsigned iterations;
     public: 
-        GraphSolver() : maxIters(1000UL) {};
-        GraphSolver(unsigned iters) : maxIters(iters) {};
+        GraphSolver() : GraphSolver(1000UL) {};
+        GraphSolver(unsigned iters) : maxIters(iters), termination(GraphTermination::Running), iterations(0) {};
+        GraphTermination getTermination() const {return termination;}
+        unsigned getIterations() const {return iterations;}
 };
 #define SUDOKU_GRAPH_SOLVER_DEF(name) class name : public virtual GraphSolver { \
     public: \
+        using Solver::solve; \
         void solve(Puzzle&) override; \
         name()=default; \
         name(unsigned iters) : GraphSolver(iters) {}; \
@@ -56,6 +186,91 @@ SUDOKU_GRAPH_SOLVER_DEF(SimpleAdditiveGraphSolver)
 SUDOKU_GRAPH_SOLVER_DEF(AdditiveGraphSolver)
 SUDOKU_GRAPH_SOLVER_DEF(MultiplicativeGraphSolver)
 
+#define HYBRID_DEFAULT_GRAPH_ITERS 20
+// Runs a bounded additive graph collapse, then finishes with an exact candidate 
+// search which tries the values favored by the collapsed graph first
+class HybridGraphSolver : public virtual GraphSolver {
+    public:
+        using Solver::solve;
+        void solve(Puzzle&) override;
+        HybridGraphSolver() : GraphSolver(HYBRID_DEFAULT_GRAPH_ITERS) {};
+        HybridGraphSolver(unsigned iters) : GraphSolver(iters) {};
+};
+
+// Answers every puzzle isomorphic to one solved before from a SolutionCache, keyed by
+// the canonical form of the givens: the cached canonical solution is mapped back through
+// the inverse transform. Other puzzles are solved by inner (owned) and their solutions
+// cached. The cache may be shared by the caching solvers of several threads.
+class CachingSolver : public virtual Solver {
+    private:
+        std::unique_ptr<Solver> inner;
+        std::shared_ptr<SolutionCache> cache;
+    public:
+        CachingSolver(Solver *inner, std::shared_ptr<SolutionCache> cache = nullptr) : 
+            inner(inner), cache(cache ? cache : std::make_shared<SolutionCache>()) {};
+        using Solver::solve;
+        void solve(Puzzle&) override;
+        SolutionCache &getCache() const { return *cache; }
+};
+
+#define PORTFOLIO_CLUE_BUCKET 4 // puzzles whose clue counts round down to the same multiple share a history
+
+// Races several engines (owned) on copies of the puzzle and keeps the first conclusive
+// answer, a solution or a proof that there is none, cancelling the other engines through
+// a token chained to the caller's. Up to threads engines run at once (zero runs them all),
+// the first on the calling thread, and the rest start as threads free up. Engines start
+// in the order given, or with learning, by their expected time to win on earlier puzzles
+// of the same size and a similar number of clues: the time they spent (cancelled runs
+// included) per win. Engines not yet tried there go first, and engines which never won
+// go last. Each engine gets the caller's deadline and the whole work budget, as engines
+// count different units of work.
+class PortfolioSolver : public virtual Solver {
+    private:
+        typedef struct engine_history_t {
+            uint64_t elapsed = 0; // nanoseconds over every run
+            unsigned runs = 0;
+            unsigned wins = 0;
+        } engine_history_t;
+
+        std::vector<std::unique_ptr<Solver>> engines;
+        const unsigned threads;
+        const bool learn;
+        std::map<unsigned, std::vector<engine_history_t>> history; // of every engine, by size and clue bucket
+        int winner; // engine which concluded the last solve, or -1
+
+        void rank(const Puzzle &puzzle, unsigned &bucket, std::vector<unsigned> &order) const;
+    public:
+        PortfolioSolver(const std::vector<Solver *> &engines, unsigned threads = 0, bool learn = true);
+        using Solver::solve;
+        void solve(Puzzle&) override;
+        unsigned getNumEngines() const { return engines.size(); }
+        int getWinner() const { return winner; }
+        // Wins of an engine over every size and clue bucket
+        unsigned getWins(unsigned engine) const;
+};
+
+// puzzles propagated in lockstep, one 16-bit candidate mask per lane of a vector register
+#ifdef __AVX2__
+    #define BATCH_LANES 16
+#else
+    #define BATCH_LANES 8
+#endif
+#define BATCH_MAX_SIZE 16 // larger puzzles don't fit a lane and are searched one at a time
+
+// Solves puzzles BATCH_LANES at a time for throughput. The batch is held as a structure of
+// arrays, one vector of candidate masks per cell with a lane per puzzle, and naked and hidden
+// singles are propagated in every lane at once over the rows, columns and boxes until no lane
+// changes. Lanes left with open cells are then searched one at a time by a scalar depth first
+// search from their propagated candidates, within the limits of options. Vector code needs
+// GCC or Clang and the SIMD cmake option; otherwise the lanes are plain loops. Stats count
+// propagation sweeps as iterations and the cells they fixed as collapses.
+class BatchSolver : public virtual Solver {
+    public:
+        using Solver::solve;
+        void solve(Puzzle&) override; // a batch of one
+        void solveBatch(Puzzle *puzzles, unsigned count, SolveStatus *statuses = nullptr) override;
+};
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#ifndef SUDOKU_ANNEALING_H
+#define SUDOKU_ANNEALING_H
+
+#include "puzzle.h"
+
+#define ANNEAL_MAX_DELTA 8 // largest cost change of a single row swap (four columns and four boxes)
+
+// Annealing state in which every row holds each value exactly once, so the cost 
+// of a state is the number of repeated values over all columns and boxes. Value 
+// counts are kept per column and box, so the cost change of swapping two cells 
+// in a row is computed in constant time without touching the grid.
+typedef struct anneal_state_t {
+    unsigned char size;
+    unsigned char sizeSqrt;
+    unsigned sizeSquared;
+    unsigned cost;
+    unsigned char *values;
+    unsigned char *colCounts; // colCounts[col * (size + 1) + value]
+    unsigned char *boxCounts; // boxCounts[box * (size + 1) + value]
+    unsigned char *boxOf;
+    unsigned char *freeCols; // freeCols[row * size + i] is the ith initially empty column of row
+    unsigned char *numFree;
+    unsigned char *swapRows; // rows with at least two initially empty cells
+    unsigned numSwapRows;
+
+    anneal_state_t(const Puzzle &puzzle) {
+        size = puzzle.getSize();
+        sizeSqrt = puzzle.getSizeSqrt();
+        sizeSquared = size * size;
+        values = new unsigned char[sizeSquared];
+        colCounts = new unsigned char[2 * size * (size + 1)];
+        boxCounts = colCounts + size * (size + 1);
+        boxOf = new unsigned char[size];
+        freeCols = new unsigned char[sizeSquared];
+        numFree = new unsigned char[size];
+        swapRows = new unsigned char[size];
+        numSwapRows = 0;
+
+        for (unsigned char col = 0; col < size; col++) boxOf[col] = col / sizeSqrt;
+
+        // initialize the empty cells so each row has every value
+        for (unsigned char row = 0; row < size; row++) {
+            unsigned rowOffset = row * size;
+            bool used[size + 1] = {};
+            numFree[row] = 0;
+            for (unsigned char col = 0; col < size; col++) {
+                if (puzzle.isConcrete(rowOffset + col)) used[puzzle.getValue(rowOffset + col)] = true;
+                else freeCols[rowOffset + numFree[row]++] = col;
+            }
+            unsigned char value = 1;
+            for (unsigned char col = 0; col < size; col++) {
+                unsigned cell = rowOffset + col;
+                if (puzzle.isConcrete(cell)) { values[cell] = puzzle.getValue(cell); continue; }
+                while (used[value]) value++;
+                values[cell] = value++;
+            }
+            if (numFree[row] > 1) swapRows[numSwapRows++] = row;
+        }
+
+        // count values in every column and box
+        for (unsigned i = 0; i < 2 * size * (size + 1U); i++) colCounts[i] = 0;
+        cost = 0;
+        for (unsigned cell = 0; cell < sizeSquared; cell++) {
+            unsigned char row = cell / size, col = cell % size;
+            unsigned box = (row / sizeSqrt) * sizeSqrt + boxOf[col];
+            cost += colCounts[col * (size + 1) + values[cell]]++ > 0;
+            cost += boxCounts[box * (size + 1) + values[cell]]++ > 0;
+        }
+    }
+
+    ~anneal_state_t() {
+        delete[] values;
+        delete[] colCounts;
+        delete[] boxOf;
+        delete[] freeCols;
+        delete[] numFree;
+        delete[] swapRows;
+    }
+
+    // change in cost if the values in columns col1 and col2 of row were swapped
+    int swapDelta(unsigned char row, unsigned char col1, unsigned char col2) const {
+        unsigned rowOffset = row * size;
+        unsigned char a = values[rowOffset + col1], b = values[rowOffset + col2];
+        const unsigned char *count1 = colCounts + col1 * (size + 1), *count2 = colCounts + col2 * (size + 1);
+        // col1 loses a and gains b; col2 loses b and gains a
+        int delta = (count1[b] > 0) - (count1[a] > 1) + (count2[a] > 0) - (count2[b] > 1);
+        if (boxOf[col1] != boxOf[col2]) {
+            unsigned boxOffset = (row / sizeSqrt) * sizeSqrt;
+            count1 = boxCounts + (boxOffset + boxOf[col1]) * (size + 1);
+            count2 = boxCounts + (boxOffset + boxOf[col2]) * (size + 1);
+            delta += (count1[b] > 0) - (count1[a] > 1) + (count2[a] > 0) - (count2[b] > 1);
+        }
+        return delta;
+    }
+
+    void swap(unsigned char row, unsigned char col1, unsigned char col2, int delta) {
+        unsigned rowOffset = row * size;
+        unsigned char a = values[rowOffset + col1], b = values[rowOffset + col2];
+        unsigned char *count1 = colCounts + col1 * (size + 1), *count2 = colCounts + col2 * (size + 1);
+        count1[a]--; count1[b]++; count2[b]--; count2[a]++;
+        if (boxOf[col1] != boxOf[col2]) {
+            unsigned boxOffset = (row / sizeSqrt) * sizeSqrt;
+            count1 = boxCounts + (boxOffset + boxOf[col1]) * (size + 1);
+            count2 = boxCounts + (boxOffset + boxOf[col2]) * (size + 1);
+            count1[a]--; count1[b]++; count2[b]--; count2[a]++;
+        }
+        values[rowOffset + col1] = b;
+        values[rowOffset + col2] = a;
+        cost += delta;
+    }
+
+    void writeTo(Puzzle &puzzle) const {
+        for (unsigned cell = 0; cell < sizeSquared; cell++)
+            if (!puzzle.isConcrete(cell)) puzzle.setValueUnchecked(cell, values[cell]);
+    }
+} anneal_state_t;
+
+#endif // SUDOKU_ANNEALING_H
@@ -0,0 +1,54 @@
+#ifndef SUDOKU_STATS_H
+#define SUDOKU_STATS_H
+
+#include <cstdint>
+
+// Search effort counters kept by every solver. Counting compiles away entirely
+// unless SUDOKU_STATS_ENABLED is defined (the STATS cmake option, on by default),
+// in which case each count is a plain increment of a member of the solver.
+typedef struct solver_stats_t {
+    uint64_t nodes = 0; // values tried by depth first searches
+    uint64_t backtracks = 0; // cells a search had to give up on
+    uint64_t eliminations = 0; // candidates ruled out by constraints at branching cells
+    uint64_t movesProposed = 0; // annealing swaps proposed
+    uint64_t movesAccepted = 0; // annealing swaps accepted
+    uint64_t reheats = 0; // annealing heats started
+    uint64_t iterations = 0; // graph collapse iterations
+    uint64_t collapses = 0; // cells collapsed by graph iterations
+
+    solver_stats_t & operator+=(const solver_stats_t &other) {
+        nodes += other.nodes;
+        backtracks += other.backtracks;
+        eliminations += other.eliminations;
+        movesProposed += other.movesProposed;
+        movesAccepted += other.movesAccepted;
+        reheats += other.reheats;
+        iterations += other.iterations;
+        collapses += other.collapses;
+        return *this;
+    }
+    solver_stats_t & operator-=(const solver_stats_t &other) {
+        nodes -= other.nodes;
+        backtracks -= other.backtracks;
+        eliminations -= other.eliminations;
+        movesProposed -= other.movesProposed;
+        movesAccepted -= other.movesAccepted;
+        reheats -= other.reheats;
+        iterations -= other.iterations;
+        collapses -= other.collapses;
+        return *this;
+    }
+} solver_stats_t;
+
+#ifdef SUDOKU_STATS_ENABLED
+    #define STATS_ADD(stats, field, count) ((stats).field += (count));
+    #define STATS_INC(stats, field) ((stats).field++);
+    #define STATS_STATEMENT(statement) statement;
+#else
+    // the arguments are still read, so values kept only for counting don't warn as unused
+    #define STATS_ADD(stats, field, count) ((void) (stats), (void) (count));
+    #define STATS_INC(stats, field) ((void) (stats));
+    #define STATS_STATEMENT(statement)
+#endif
+
+#endif // SUDOKU_STATS_H
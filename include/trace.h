@@ -0,0 +1,139 @@
+#ifndef SUDOKU_TRACE_H
+#define SUDOKU_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef TRACE_BUFFER_EVENTS
+ #define TRACE_BUFFER_EVENTS (1U << 16) // events kept per thread, a power of two
+#endif
+#define TRACE_FILE_MAGIC "SDKTRACE"
+#define TRACE_FILE_VERSION 1
+
+enum TraceEvent : uint16_t {
+    TRACE_SOLVE, // one call to a solver's solve (value: 1 if solved)
+    TRACE_BACKTRACK, // a depth first search gave up on a cell
+    TRACE_BRANCH, // a candidate search guessed at a cell (value: candidates left)
+    TRACE_HEAT, // one annealing heat (value: conflicts left)
+    TRACE_EXCHANGE, // a parallel tempering exchange round (value: round)
+    TRACE_GRAPH_ITERATION, // one graph collapse iteration (value: iteration)
+    TRACE_NUM_EVENTS
+};
+
+enum TracePhase : uint8_t {
+    TRACE_PHASE_BEGIN = 'B',
+    TRACE_PHASE_END = 'E',
+    TRACE_PHASE_INSTANT = 'i'
+};
+
+const char * traceEventName(uint16_t event);
+
+// Fixed size binary record, written to trace files as is
+typedef struct trace_event_t {
+    uint64_t timestamp; // steady clock nanoseconds
+    uint32_t thread; // trace thread id, in order of each thread's first event
+    uint16_t event;
+    uint8_t phase;
+    uint8_t reserved;
+    uint32_t cell;
+    uint32_t value;
+} trace_event_t;
+static_assert(sizeof(trace_event_t) == 24, "trace events are written to files as raw bytes");
+
+// Ring buffer of the most recent events of one thread. Only its owning thread
+// records into it, so recording takes no lock: the event is written and then
+// published by advancing the head.
+class TraceBuffer {
+    private:
+        trace_event_t events[TRACE_BUFFER_EVENTS];
+        std::atomic<uint64_t> head {0}; // events recorded since the last clear
+    public:
+        void record(const trace_event_t &event) {
+            uint64_t position = head.load(std::memory_order_relaxed);
+            events[position & (TRACE_BUFFER_EVENTS - 1)] = event;
+            head.store(position + 1, std::memory_order_release);
+        }
+        // appends the retained events, oldest first
+        void copyTo(std::vector<trace_event_t> &out) const;
+        void clear() { head.store(0, std::memory_order_release); }
+};
+
+// Owns every thread's buffer. A thread gets a buffer on its first event and hands
+// it back when it exits, so short lived solver threads reuse buffers (their events
+// keep their own thread id) instead of growing the trace.
+class TraceLog {
+    private:
+        std::mutex mutex; // guards the buffer lists only, never held while recording
+        std::vector<std::unique_ptr<TraceBuffer>> buffers;
+        std::vector<TraceBuffer *> idle;
+        std::atomic<uint32_t> nextThread {0};
+
+        TraceLog() {}
+    public:
+        static TraceLog &GetInstance() {
+            static TraceLog log;
+            return log;
+        }
+        TraceLog(const TraceLog&) = delete;
+        TraceLog & operator=(const TraceLog&) = delete;
+
+        TraceBuffer *acquire(uint32_t &thread);
+        void release(TraceBuffer *buffer);
+
+        // Retained events of every thread, sorted by time. Threads still recording
+        // may have their newest events missed or torn, so collect while solvers are idle.
+        std::vector<trace_event_t> collect();
+        void clear();
+
+        // Binary trace file: magic, version, event size, the event name table, then
+        // the event count and the raw events. Returns false if the file cannot be written.
+        bool write(const std::string &filepath);
+        static bool read(const std::string &filepath, std::vector<std::string> &names,
+            std::vector<trace_event_t> &events);
+
+        // Records an event in the calling thread's buffer
+        static void record(uint16_t event, uint8_t phase, uint32_t cell, uint32_t value);
+};
+
+// Ties a thread to its buffer, returning the buffer to the log when the thread exits
+typedef struct trace_thread_t {
+    TraceBuffer *buffer;
+    uint32_t id;
+
+    trace_thread_t() { buffer = TraceLog::GetInstance().acquire(id); }
+    ~trace_thread_t() { TraceLog::GetInstance().release(buffer); }
+} trace_thread_t;
+
+inline void TraceLog::record(uint16_t event, uint8_t phase, uint32_t cell, uint32_t value) {
+    static thread_local trace_thread_t thread;
+    trace_event_t record;
+    record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    record.thread = thread.id;
+    record.event = event;
+    record.phase = phase;
+    record.reserved = 0;
+    record.cell = cell;
+    record.value = value;
+    thread.buffer->record(record);
+}
+
+// Tracing compiles away entirely unless SUDOKU_TRACE_ENABLED is defined (the TRACE
+// cmake option, off by default). Unlike verbose debugging, recording an event is a
+// clock read and a 24 byte store, cheap enough to leave on under load.
+#ifdef SUDOKU_TRACE_ENABLED
+    #define TRACE_BEGIN(event, cell, value) TraceLog::record(event, TRACE_PHASE_BEGIN, cell, value);
+    #define TRACE_END(event, cell, value) TraceLog::record(event, TRACE_PHASE_END, cell, value);
+    #define TRACE_INSTANT(event, cell, value) TraceLog::record(event, TRACE_PHASE_INSTANT, cell, value);
+#else
+    #define TRACE_BEGIN(event, cell, value)
+    #define TRACE_END(event, cell, value)
+    #define TRACE_INSTANT(event, cell, value)
+#endif
+
+#endif // SUDOKU_TRACE_H
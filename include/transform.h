@@ -0,0 +1,34 @@
+#ifndef SUDOKU_TRANSFORM_H
+#define SUDOKU_TRANSFORM_H
+
+#include <vector>
+
+#include "random.h"
+
+// A composition of the transformations which map every valid sudoku grid to a
+// valid grid: transposition, then row and column permutations which only move
+// rows within their band (and whole bands), columns within their stack (and
+// whole stacks), then a relabeling of the digits. Empty cells stay empty, so
+// puzzles keep their number of solutions.
+typedef struct sudoku_transform_t {
+	unsigned char size;
+	bool transpose;
+	std::vector<unsigned char> rows; // row r of the result is row rows[r] of the (transposed) source
+	std::vector<unsigned char> cols; // column c of the result is column cols[c] of the (transposed) source
+	std::vector<unsigned char> relabel; // value v becomes relabel[v], with relabel[0] = 0
+
+	static sudoku_transform_t identity(unsigned char size);
+	// Uniformly random transformation: bands, rows within bands, stacks, columns
+	// within stacks, digits and transposition are all drawn independently
+	static sudoku_transform_t random(unsigned char size, Random &random);
+
+	// Transformation undoing this one, so inverse().apply(target, source) restores the source
+	sudoku_transform_t inverse() const;
+
+	// Writes the transformed grid of size * size values to target, which must not alias source
+	void apply(const unsigned char *source, unsigned char *target) const;
+	// False if a permutation moves a row or column out of its band or stack
+	bool isValid() const;
+} sudoku_transform_t;
+
+#endif // SUDOKU_TRANSFORM_H
@@ -0,0 +1,14 @@
+#include "budget.h"
+
+const char * solveStatusName(SolveStatus status) {
+	switch (status) {
+		case SolveStatus::Running: return "running";
+		case SolveStatus::Solved: return "solved";
+		case SolveStatus::Unsolvable: return "unsolvable";
+		case SolveStatus::Unsolved: return "unsolved";
+		case SolveStatus::BudgetExhausted: return "budget exhausted";
+		case SolveStatus::TimedOut: return "timed out";
+		case SolveStatus::Cancelled: return "cancelled";
+	}
+	return "unknown";
+}
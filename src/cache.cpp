@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include "cache.h"
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+SolutionCache::SolutionCache(size_t capacity, unsigned shards) : shards(new cache_shard_t[std::max(1U, shards)]),
+	numShards(std::max(1U, shards)), shardCapacity(std::max<size_t>(1, capacity / std::max(1U, shards))), hits(0), misses(0)
+{
+	DEBUG_OUTPUT("SolutionCache::SolutionCache(%lu, %d)", (unsigned long) capacity, shards)
+}
+
+bool SolutionCache::lookup(const canonical_form_t &puzzle, unsigned char *solution) {
+	cache_shard_t &shard = shardOf(puzzle.hash);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto found = shard.index.find(puzzle.hash);
+	if (found == shard.index.end() || found->second->puzzle != puzzle.values) {
+		misses++;
+		return false;
+	}
+	shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+	std::copy(found->second->solution.begin(), found->second->solution.end(), solution);
+	hits++;
+	return true;
+}
+
+void SolutionCache::insert(const canonical_form_t &puzzle, const unsigned char *solution) {
+	cache_shard_t &shard = shardOf(puzzle.hash);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto found = shard.index.find(puzzle.hash);
+	if (found != shard.index.end()) {
+		// refresh the entry, replacing a puzzle which only shared the hash
+		cache_entry_t &entry = *found->second;
+		entry.puzzle = puzzle.values;
+		entry.solution.assign(solution, solution + puzzle.values.size());
+		shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+		return;
+	}
+	if (shard.entries.size() >= shardCapacity) {
+		DEBUG_OUTPUT("Evicting the least recently used solution")
+		shard.index.erase(shard.entries.back().hash);
+		shard.entries.pop_back();
+	}
+	shard.entries.push_front({puzzle.hash, puzzle.values,
+		std::vector<unsigned char>(solution, solution + puzzle.values.size())});
+	shard.index[puzzle.hash] = shard.entries.begin();
+}
+
+void SolutionCache::clear() {
+	for (cache_shard_t *shard = shards.get(), *shardMax = shard + numShards; shard < shardMax; shard++) {
+		std::lock_guard<std::mutex> lock(shard->mutex);
+		shard->entries.clear();
+		shard->index.clear();
+	}
+	hits = misses = 0;
+}
+
+size_t SolutionCache::size() {
+	size_t total = 0;
+	for (cache_shard_t *shard = shards.get(), *shardMax = shard + numShards; shard < shardMax; shard++) {
+		std::lock_guard<std::mutex> lock(shard->mutex);
+		total += shard->entries.size();
+	}
+	return total;
+}
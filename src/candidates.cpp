@@ -0,0 +1,270 @@
+#include "candidates.h"
+#include "puzzle.h"
+#include "graph.h"
+#include "trace.h"
+#include <vector>
+
+// #define DEBUG_ENABLED
+// #define DEBUG_ENABLED_VERBOSE
+#include "debugging.h"
+
+
+void CandidateGrid::initializeSize(unsigned char size) {
+	this->size = size;
+	this->sizeSqrt = perfectSqrt(size);
+	this->sizeSquared = size * size;
+	this->fullMask = size >= 32 ? ~0U : (1U << size) - 1;
+	this->values = new unsigned char[this->sizeSquared * 4];
+	this->rowOf = this->values + this->sizeSquared;
+	this->colOf = this->rowOf + this->sizeSquared;
+	this->boxOf = this->colOf + this->sizeSquared;
+	this->rowUsed = new unsigned[3 * size];
+	this->colUsed = this->rowUsed + size;
+	this->boxUsed = this->colUsed + size;
+	this->units = graphNeighborhoods(size);
+}
+
+CandidateGrid::CandidateGrid(const Puzzle &puzzle, bool givensOnly) {
+	DEBUG_FUNC_HEADER("CandidateGrid::CandidateGrid(Puzzle&, givensOnly=%s)", givensOnly ? "true" : "false")
+	this->initializeSize(puzzle.getSize());
+	this->numEmpty = this->sizeSquared;
+	this->consistent = true;
+
+	for (unsigned *used = rowUsed, *usedMax = used + 3 * size; used < usedMax; used++) *used = 0;
+
+	for (unsigned cell = 0, row = 0, col = 0; cell < sizeSquared; cell++) {
+		rowOf[cell] = row;
+		colOf[cell] = col;
+		boxOf[cell] = (row / sizeSqrt) * sizeSqrt + col / sizeSqrt;
+		values[cell] = 0;
+		if (++col == size) { col = 0; row++; }
+	}
+
+	for (unsigned cell = 0; cell < sizeSquared; cell++) {
+		unsigned char value = puzzle.getValue(cell);
+		if (value == 0 || (givensOnly && !puzzle.isConcrete(cell))) continue;
+		if (!(candidates(cell) & CANDIDATE_BIT(value))) {
+			DEBUG_OUTPUT("Conflicting value %d found at row %d and column %d", value, CELL_TO_COORDS(cell, size))
+			consistent = false;
+		}
+		place(cell, value);
+	}
+	DEBUG_FUNC_END()
+}
+
+CandidateGrid::CandidateGrid(const CandidateGrid &other) {
+	this->initializeSize(other.size);
+	this->numEmpty = other.numEmpty;
+	this->consistent = other.consistent;
+	for (unsigned i = 0; i < sizeSquared * 4; i++) values[i] = other.values[i];
+	for (unsigned i = 0; i < 3U * size; i++) rowUsed[i] = other.rowUsed[i];
+}
+
+CandidateGrid::~CandidateGrid() {
+	delete[] values;
+	delete[] rowUsed;
+}
+
+void CandidateGrid::place(unsigned cell, unsigned char value) {
+	unsigned bit = CANDIDATE_BIT(value);
+	values[cell] = value;
+	rowUsed[rowOf[cell]] |= bit;
+	colUsed[colOf[cell]] |= bit;
+	boxUsed[boxOf[cell]] |= bit;
+	numEmpty--;
+}
+
+void CandidateGrid::remove(unsigned cell) {
+	unsigned bit = ~CANDIDATE_BIT(values[cell]);
+	values[cell] = 0;
+	rowUsed[rowOf[cell]] &= bit;
+	colUsed[colOf[cell]] &= bit;
+	boxUsed[boxOf[cell]] &= bit;
+	numEmpty++;
+}
+
+unsigned CandidateGrid::findMostConstrained(unsigned &mask) const {
+	unsigned best = sizeSquared, bestCount = size + 1;
+	for (unsigned cell = 0; cell < sizeSquared; cell++) {
+		if (values[cell]) continue;
+		unsigned cellMask = candidates(cell);
+		unsigned count = __builtin_popcount(cellMask);
+		if (count < bestCount) {
+			best = cell;
+			bestCount = count;
+			mask = cellMask;
+			// a cell cannot be more constrained than forced or dead
+			if (count <= 1) break;
+		}
+	}
+	return best;
+}
+
+bool CandidateGrid::propagate(std::vector<unsigned> &placed) {
+	bool changed = true;
+	while (changed) {
+		changed = false;
+
+		// naked singles
+		for (unsigned cell = 0; cell < sizeSquared; cell++) {
+			if (values[cell]) continue;
+			unsigned mask = candidates(cell);
+			if (mask == 0) return false;
+			if (mask & (mask - 1)) continue;
+			place(cell, __builtin_ctz(mask) + 1);
+			placed.push_back(cell);
+			changed = true;
+		}
+
+		// hidden singles in every row, column and box
+		for (unsigned ***type = units, ***typeMax = units + 3; type < typeMax; type++) {
+			for (unsigned **unit = *type, **unitMax = unit + size; unit < unitMax; unit++) {
+				unsigned used = 0, once = 0, twice = 0;
+				for (unsigned *cell = *unit, *cellMax = cell + size; cell < cellMax; cell++) {
+					if (values[*cell]) {
+						used |= CANDIDATE_BIT(values[*cell]);
+						continue;
+					}
+					unsigned mask = candidates(*cell);
+					twice |= once & mask;
+					once |= mask;
+				}
+				if ((used | once) != fullMask) return false;
+				for (unsigned hidden = once & ~twice; hidden; hidden &= hidden - 1) {
+					unsigned bit = hidden & -hidden;
+					for (unsigned *cell = *unit, *cellMax = cell + size; cell < cellMax; cell++) {
+						// an earlier placement may have taken the value, caught by the next pass
+						if (values[*cell] || !(candidates(*cell) & bit)) continue;
+						place(*cell, __builtin_ctz(bit) + 1);
+						placed.push_back(*cell);
+						changed = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+unsigned CandidateGrid::countSolutions(unsigned limit) {
+	DEBUG_FUNC_HEADER("CandidateGrid::countSolutions(%d)", limit)
+	if (!consistent || limit == 0) {
+		DEBUG_FUNC_RETURN(0)
+		return 0;
+	}
+
+	// each frame holds a branching cell, the candidates left to try there, and
+	// the length of the trail of placements before the branch
+	struct frame_t { unsigned cell; unsigned remaining; size_t trail; };
+	std::vector<frame_t> stack;
+	std::vector<unsigned> trail;
+	trail.reserve(numEmpty);
+
+	unsigned found = 0;
+	bool alive = propagate(trail);
+	while (true) {
+		if (alive) {
+			unsigned mask = 0;
+			unsigned cell = findMostConstrained(mask);
+			if (cell == sizeSquared) {
+				if (++found >= limit) break;
+			}
+			else {
+				// propagation leaves no empty cell without candidates
+				unsigned bit = mask & -mask;
+				stack.push_back({cell, mask & ~bit, trail.size()});
+				place(cell, __builtin_ctz(bit) + 1);
+				trail.push_back(cell);
+				alive = propagate(trail);
+				continue;
+			}
+		}
+
+		// undo the deepest branch and try its next candidate
+		alive = false;
+		while (!stack.empty()) {
+			frame_t &frame = stack.back();
+			for (; trail.size() > frame.trail; trail.pop_back()) remove(trail.back());
+			if (frame.remaining) {
+				unsigned bit = frame.remaining & -frame.remaining;
+				frame.remaining &= ~bit;
+				place(frame.cell, __builtin_ctz(bit) + 1);
+				trail.push_back(frame.cell);
+				alive = propagate(trail);
+				break;
+			}
+			stack.pop_back();
+		}
+		if (stack.empty()) break;
+	}
+
+	// restore the grid to its initial state
+	for (; !trail.empty(); trail.pop_back()) remove(trail.back());
+
+	DEBUG_FUNC_RETURN(found)
+	return found;
+}
+
+unsigned countSolutions(const Puzzle &puzzle, unsigned limit) {
+	CandidateGrid grid(puzzle);
+	return grid.countSolutions(limit);
+}
+
+unsigned CandidateSearch::search(unsigned limit, unsigned char *solution) {
+	DEBUG_FUNC_HEADER("CandidateSearch::search(%d, unsigned char*)", limit)
+	if (!grid.isConsistent() || limit == 0) {
+		DEBUG_FUNC_RETURN(0)
+		return 0;
+	}
+
+	// each frame holds a branching cell and the candidates left to try there
+	struct frame_t { unsigned cell; unsigned remaining; };
+	std::vector<frame_t> stack;
+	stack.reserve(grid.getNumEmpty());
+
+	unsigned found = 0;
+	while (!(budget && budget->spend())) {
+		unsigned mask = 0;
+		unsigned cell = grid.findMostConstrained(mask);
+
+		if (cell == grid.getSizeSquared()) {
+			// every cell is filled without conflict
+			if (found++ == 0 && solution != nullptr)
+				for (unsigned c = 0; c < grid.getSizeSquared(); c++) solution[c] = grid.getValue(c);
+			if (found >= limit) break;
+		}
+		else if (mask != 0) {
+			// branch on the most constrained cell
+			eliminations += grid.getSize() - __builtin_popcount(mask);
+			TRACE_INSTANT(TRACE_BRANCH, cell, __builtin_popcount(mask))
+			unsigned char value = nextValue(cell, mask);
+			stack.push_back({cell, mask & ~CANDIDATE_BIT(value)});
+			grid.place(cell, value);
+			nodes++;
+			continue;
+		}
+
+		// backtrack to the deepest frame which still has candidates to try
+		while (!stack.empty()) {
+			frame_t &frame = stack.back();
+			grid.remove(frame.cell);
+			if (frame.remaining) {
+				unsigned char value = nextValue(frame.cell, frame.remaining);
+				frame.remaining &= ~CANDIDATE_BIT(value);
+				grid.place(frame.cell, value);
+				nodes++;
+				break;
+			}
+			stack.pop_back();
+			backtracks++;
+		}
+		if (stack.empty()) break;
+	}
+
+	// restore the grid to its initial state
+	for (frame_t &frame : stack) grid.remove(frame.cell);
+
+	DEBUG_FUNC_RETURN(found)
+	return found;
+}
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cstring>
+
+#include "canonical.h"
+#include "puzzle.h"
+#include "random.h"
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+uint64_t canonicalHash(unsigned char size, const unsigned char *values) {
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (const unsigned char *value = values, *valueMax = values + size * size; value < valueMax; value++)
+		hash = (hash ^ *value) * 0x100000001B3ULL;
+	return splitmix64(hash);
+}
+
+// Column order known after the rows placed so far: the source stack at every slot and the
+// source columns of every stack in order, where runs of slots or columns ending at a set
+// group end may still come in any order. Also holds the digit labels given so far.
+typedef struct column_state_t {
+	unsigned char slots[CANONICAL_MAX_SQRT];
+	bool slotGroupEnd[CANONICAL_MAX_SQRT];
+	unsigned char within[CANONICAL_MAX_SIZE]; // source columns of stack k from within[k * sizeSqrt]
+	bool groupEnd[CANONICAL_MAX_SIZE];
+	unsigned char labels[CANONICAL_MAX_SIZE + 1];
+	unsigned char nextLabel;
+} column_state_t;
+
+typedef struct canonical_branch_t {
+	unsigned char row;
+	column_state_t state;
+} canonical_branch_t;
+
+// Branch and bound over the rows of one (possibly transposed) grid. Every row is placed
+// with the column order which relabels it smallest among those the earlier rows allow,
+// and the search branches wherever rows, stacks or new digits tie.
+class CanonicalSearch {
+	private:
+		const unsigned char size, sizeSqrt;
+		const unsigned char *grid;
+		bool transpose;
+		std::vector<unsigned char> rows; // source row placed at every depth
+		std::vector<column_state_t> states; // column order before every depth
+		std::vector<std::vector<canonical_branch_t>> branches; // tied smallest rows of every depth
+		std::vector<unsigned char> current; // relabeled rows placed so far
+		std::vector<unsigned char> candidate;
+		unsigned usedRows, usedBands;
+		unsigned long updates;
+
+		// counted is false for the column orders of a row after its first, see search
+		void search(unsigned depth, bool better, bool counted);
+		// Writes row from column position on with the smallest values the state allows,
+		// branching on every tie, and cuts any prefix larger than bound (order is the
+		// comparison of the prefix so far with bound, or -1 if there is no bound)
+		void placeRow(unsigned depth, unsigned char row, column_state_t &state, unsigned char position,
+			const unsigned char *bound, int order);
+		void addBranch(unsigned depth, unsigned char row, const column_state_t &state);
+		// Writes the columns of the group of stack starting at index to sorted, empty cells
+		// first, then digits by label, then new digits. Returns the end of the group.
+		unsigned char sortGroup(const column_state_t &state, const unsigned char *source, unsigned char stack,
+			unsigned char index, unsigned char *sorted, unsigned char &zeros, unsigned char &newDigits) const;
+
+	public:
+		canonical_form_t best;
+		bool found;
+		unsigned long nodes;
+
+		CanonicalSearch(unsigned char size) : size(size), sizeSqrt(perfectSqrt(size)), rows(size), states(size + 1),
+			branches(size), current(size * size), candidate(size), updates(0), found(false), nodes(0)
+			{ best.values.resize(size * size); }
+
+		void run(const unsigned char *grid, bool transpose);
+};
+
+unsigned char CanonicalSearch::sortGroup(const column_state_t &state, const unsigned char *source, unsigned char stack,
+	unsigned char index, unsigned char *sorted, unsigned char &zeros, unsigned char &newDigits
+) const {
+	const unsigned char *within = state.within + stack * sizeSqrt;
+	unsigned char end = index;
+	while (!state.groupEnd[stack * sizeSqrt + end]) end++;
+	end++;
+
+	unsigned char count = 0;
+	for (unsigned char i = index; i < end; i++) if (!source[within[i]]) sorted[count++] = within[i];
+	zeros = count;
+	for (unsigned char i = index; i < end; i++) {
+		unsigned char value = source[within[i]];
+		if (!value || !state.labels[value]) continue;
+		unsigned char j = count++;
+		while (j > zeros && state.labels[source[sorted[j - 1]]] > state.labels[value]) { sorted[j] = sorted[j - 1]; j--; }
+		sorted[j] = within[i];
+	}
+	unsigned char labeled = count;
+	for (unsigned char i = index; i < end; i++) {
+		unsigned char value = source[within[i]];
+		if (value && !state.labels[value]) sorted[count++] = within[i];
+	}
+	newDigits = count - labeled;
+	return end;
+}
+
+void CanonicalSearch::addBranch(unsigned depth, unsigned char row, const column_state_t &state) {
+	std::vector<canonical_branch_t> &tied = branches[depth];
+	unsigned char *minimum = current.data() + depth * size;
+	int order = tied.empty() ? -1 : std::memcmp(candidate.data(), minimum, size);
+	if (order > 0) return;
+	if (order < 0) {
+		std::memcpy(minimum, candidate.data(), size);
+		tied.clear();
+	}
+	tied.push_back({row, state});
+}
+
+void CanonicalSearch::placeRow(unsigned depth, unsigned char row, column_state_t &state, unsigned char position,
+	const unsigned char *bound, int order
+) {
+	if (position == size) {
+		addBranch(depth, row, state);
+		return;
+	}
+	const unsigned char *source = grid + row * size;
+	unsigned char slot = position / sizeSqrt, index = position % sizeSqrt;
+
+	// a slot opening a group of stacks takes whichever stack writes the smallest values
+	if (index == 0 && !state.slotGroupEnd[slot]) {
+		unsigned char groupEnd = slot;
+		while (!state.slotGroupEnd[groupEnd]) groupEnd++;
+		unsigned char values[sizeSqrt], minimum[sizeSqrt], sorted[sizeSqrt], tied[sizeSqrt], numTied = 0;
+		for (unsigned char member = slot; member <= groupEnd; member++) {
+			unsigned char stack = state.slots[member], next = state.nextLabel, zeros, newDigits;
+			for (unsigned char i = 0, end; i < sizeSqrt; i = end) {
+				end = sortGroup(state, source, stack, i, sorted + i, zeros, newDigits);
+				for (unsigned char j = i; j < end; j++) {
+					unsigned char value = source[sorted[j]];
+					values[j] = j < i + zeros ? 0 : j < end - newDigits ? state.labels[value] : next++;
+				}
+			}
+			int comparison = numTied ? std::memcmp(values, minimum, sizeSqrt) : -1;
+			if (comparison < 0) {
+				std::memcpy(minimum, values, sizeSqrt);
+				numTied = 0;
+			}
+			if (comparison <= 0) tied[numTied++] = member;
+		}
+		for (unsigned char *member = tied, *memberMax = tied + numTied; member < memberMax; member++) {
+			column_state_t branch = state;
+			std::swap(branch.slots[slot], branch.slots[*member]);
+			branch.slotGroupEnd[slot] = true;
+			placeRow(depth, row, branch, position, bound, order);
+		}
+		return;
+	}
+
+	// the next group of columns of the stack: its empty cells stay a group, digits split off
+	unsigned char stack = state.slots[slot], sorted[sizeSqrt], zeros, newDigits;
+	unsigned char end = sortGroup(state, source, stack, index, sorted, zeros, newDigits);
+	unsigned char *within = state.within + stack * sizeSqrt, newStart = end - newDigits;
+	bool *groupEnd = state.groupEnd + stack * sizeSqrt;
+	for (unsigned char i = index; i < end; i++) {
+		within[i] = sorted[i - index];
+		groupEnd[i] = i >= index + zeros || i + 1 == index + zeros;
+	}
+	for (unsigned char i = index; i < newStart; i++) {
+		unsigned char value = source[within[i]], label = value ? state.labels[value] : 0;
+		candidate[position + i - index] = label;
+		if (order == 0 && label != bound[position + i - index]) {
+			if (label > bound[position + i - index]) return;
+			order = -1;
+		}
+	}
+
+	// new digits are labeled in the order they appear, and every order is a branch
+	std::sort(within + newStart, within + end);
+	do {
+		column_state_t branch = state;
+		int branchOrder = order;
+		bool cut = false;
+		for (unsigned char i = newStart; i < end; i++) {
+			unsigned char label = branch.nextLabel++;
+			branch.labels[source[within[i]]] = label;
+			candidate[position + i - index] = label;
+			if (branchOrder == 0 && label != bound[position + i - index]) {
+				cut = label > bound[position + i - index];
+				branchOrder = -1;
+			}
+		}
+		if (!cut) placeRow(depth, row, branch, slot * sizeSqrt + end, bound, branchOrder);
+	} while (std::next_permutation(within + newStart, within + end));
+}
+
+void CanonicalSearch::run(const unsigned char *grid, bool transpose) {
+	this->grid = grid;
+	this->transpose = transpose;
+	usedRows = usedBands = 0;
+
+	// nothing is ordered yet: one group of stacks, and one group of columns per stack
+	column_state_t &state = states[0];
+	for (unsigned char slot = 0; slot < sizeSqrt; slot++) {
+		state.slots[slot] = slot;
+		state.slotGroupEnd[slot] = slot + 1 == sizeSqrt;
+	}
+	for (unsigned char col = 0; col < size; col++) {
+		state.within[col] = col;
+		state.groupEnd[col] = col % sizeSqrt + 1 == sizeSqrt;
+	}
+	std::fill(state.labels, state.labels + size + 1, 0);
+	state.nextLabel = 1;
+	search(0, false, true);
+}
+
+void CanonicalSearch::search(unsigned depth, bool better, bool counted) {
+	if (depth == size) {
+		// columns still in a group never differ, and digits never seen can take any label
+		column_state_t &state = states[depth];
+		for (unsigned char value = 1; value <= size; value++) if (!state.labels[value]) state.labels[value] = state.nextLabel++;
+		best.values = current;
+		best.transform.size = size;
+		best.transform.transpose = transpose;
+		best.transform.rows = rows;
+		best.transform.cols.resize(size);
+		for (unsigned char slot = 0; slot < sizeSqrt; slot++)
+			for (unsigned char i = 0; i < sizeSqrt; i++)
+				best.transform.cols[slot * sizeSqrt + i] = state.within[state.slots[slot] * sizeSqrt + i];
+		best.transform.relabel.assign(state.labels, state.labels + size + 1);
+		found = true;
+		updates++;
+		return;
+	}
+	if (found && nodes >= CANONICAL_MAX_NODES) return;
+	nodes += counted;
+
+	// rows which may come next: the first row of a band opens any unused band
+	unsigned char first = 0, last = size;
+	if (depth % sizeSqrt) {
+		first = rows[depth - depth % sizeSqrt] / sizeSqrt * sizeSqrt;
+		last = first + sizeSqrt;
+	}
+
+	// bound by the same row of the best grid, which shares every earlier row unless better
+	const unsigned char *bound = found && !better ? best.values.data() + depth * size : nullptr;
+	std::vector<canonical_branch_t> &tied = branches[depth];
+	tied.clear();
+	for (unsigned char row = first; row < last; row++) {
+		if ((usedRows >> row) & 1 || (depth % sizeSqrt == 0 && (usedBands >> (row / sizeSqrt)) & 1)) continue;
+		column_state_t state = states[depth];
+		placeRow(depth, row, state, 0, bound, bound ? 0 : -1);
+	}
+	if (tied.empty()) return;
+	if (bound) better = std::memcmp(current.data() + depth * size, bound, size) < 0;
+	// a row of new digits only reads the same in every column order (all of them, on a filled
+	// grid), so its orders share one node rather than spending the budget before the next row
+	bool interchangeable = tied[0].state.nextLabel == states[depth].nextLabel + size;
+
+	for (size_t branch = 0; branch < tied.size(); branch++) {
+		unsigned char row = tied[branch].row;
+		states[depth + 1] = tied[branch].state;
+		rows[depth] = row;
+		usedRows |= 1U << row;
+		if (depth % sizeSqrt == 0) usedBands |= 1U << (row / sizeSqrt);
+
+		unsigned long version = updates;
+		search(depth + 1, better, !interchangeable || branch == 0 || tied[branch - 1].row != row);
+		if (updates != version) better = false; // the best grid now shares this prefix
+
+		usedRows &= ~(1U << row);
+		if (depth % sizeSqrt == 0) usedBands &= ~(1U << (row / sizeSqrt));
+	}
+}
+
+canonical_form_t canonicalize(unsigned char size, const unsigned char *values) {
+	DEBUG_FUNC_HEADER("canonicalize(%d, unsigned char*)", size)
+	canonical_form_t form;
+	unsigned sizeSquared = size * size;
+	if (size > CANONICAL_MAX_SIZE) {
+		form.transform = sudoku_transform_t::identity(size);
+		form.values.assign(values, values + sizeSquared);
+		form.hash = canonicalHash(size, values);
+		DEBUG_FUNC_END()
+		return form;
+	}
+
+	unsigned char transposed[sizeSquared];
+	for (unsigned row = 0; row < size; row++)
+		for (unsigned col = 0; col < size; col++) transposed[col * size + row] = values[row * size + col];
+
+	CanonicalSearch search(size);
+	search.run(values, false);
+	search.run(transposed, true);
+	DEBUG_OUTPUT("Canonical form found after %lu row choices", search.nodes)
+
+	form = search.best;
+	form.hash = canonicalHash(size, form.values.data());
+	DEBUG_FUNC_END()
+	return form;
+}
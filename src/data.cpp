@@ -11,12 +11,9 @@
 
 PuzzleLoader::PuzzleLoader(std::string filepath, unsigned long datasetSize, unsigned char puzzleSize, unsigned seed) : 
     file(filepath), datasetSize(datasetSize), puzzleSize(puzzleSize), puzzleSizeSquared(puzzleSize*puzzleSize), 
-    seed(seed), batchSize(0)
+    seed(seed), random(seed), batchSize(0)
 {
     DEBUG_FUNC_HEADER("PuzzleLoader::PuzzleLoader(\"%s\", %d, %d, %d)", filepath.c_str(), datasetSize, puzzleSize, seed)
-    // TODO: use seed to instantiate a RNG member
-    unsigned randMaxLowerBound = RAND_MAX_LOWER_BOUND_FACTOR * datasetSize;
-    randMultiplier = randMaxLowerBound > RAND_MAX ? RAND_MAX / randMaxLowerBound : 1;
     puzzleCursor = 0;
 
     // verify file is csv
@@ -76,17 +73,16 @@ PuzzleLoader::PuzzleLoader(std::string filepath, unsigned long datasetSize, unsi
     DEBUG_FUNC_END()
 };
 
+Puzzle PuzzleLoader::load() {
+    if (this->seed == 0) return load(0);
+    // draw the seed for the next puzzle from the loader's own generator
+    return load(static_cast<unsigned>(this->random.next() >> 32) | 1);
+}
+
 Puzzle PuzzleLoader::load(unsigned seed) {
     DEBUG_FUNC_HEADER("PuzzleLoader::loadNew(%d)", seed)
     // select random puzzle
-    unsigned puzzleNumber = this->puzzleCursor++;
-
-    if (seed && this->seed) {
-        std::srand(seed);
-        puzzleNumber = std::rand() * this->randMultiplier;
-        puzzleNumber += std::rand() % this->randMultiplier;
-        puzzleNumber %= this->datasetSize;
-    }
+    unsigned puzzleNumber = seed ? Random(seed).below(this->datasetSize) : this->puzzleCursor++ % this->datasetSize;
     DEBUG_OUTPUT("Puzzle number selected: %d", puzzleNumber)
 
     // READ IN PUZZLE
@@ -109,10 +105,28 @@ Puzzle PuzzleLoader::load(unsigned seed) {
     // close file
     dataset.close();
 
+    DEBUG_FUNC_END()
+    return parse(puzzleLine);
+}
+
+bool PuzzleLoader::next(Puzzle &puzzle) {
+    if (!this->stream.is_open()) {
+        this->stream.open(this->file);
+        std::string header;
+        if (!std::getline(this->stream, header)) return false;
+    }
+    std::string puzzleLine;
+    if (!(this->stream >> puzzleLine)) return false;
+    puzzle = parse(puzzleLine);
+    return true;
+}
+
+Puzzle PuzzleLoader::parse(const std::string &puzzleLine) const {
+    DEBUG_FUNC_HEADER("PuzzleLoader::parse(%s)", puzzleLine.c_str())
     unsigned sizeSquared = puzzleLine.find_first_of(',');
 
     // DO NOT CONTINUE IF PUZZLE SIZE IS WRONG
-    if (sizeSquared != this->puzzleSizeSquared) {
+    if (sizeSquared != this->puzzleSizeSquared || puzzleLine.size() < 2 * sizeSquared + 1) {
         DEBUG_OUTPUT("Puzzle size mismatch! Returning empty puzzle")
         DEBUG_FUNC_END()
         return Puzzle(this->puzzleSize);
@@ -141,14 +155,13 @@ Puzzle PuzzleLoader::load(unsigned seed) {
 PuzzleDumper::PuzzleDumper(std::string filepath, unsigned char puzzleSize) 
     : filepath(filepath), puzzleSize(puzzleSize) 
 { 
-    this->digits = std::ceil(std::log10(puzzleSize));
+    buffer.reserve(SUDOKU_DUMPER_BUFFER_SIZE + 2 * puzzleSize * puzzleSize + 2);
     startFile(); 
 };
 
 void PuzzleDumper::startFile() {
-    std::ofstream file(this->filepath, std::ios_base::out);
-    file << "Puzzle,Solution" << std::endl;
-    file.close();
+    file.open(this->filepath, std::ios_base::out | std::ios_base::trunc);
+    buffer += "Puzzle,Solution\n";
 }
 
 void PuzzleDumper::dump(const Puzzle *puzzles, unsigned num) {
@@ -157,15 +170,19 @@ void PuzzleDumper::dump(const Puzzle *puzzles, unsigned num) {
 
 void PuzzleDumper::dump(const Puzzle &puzzle) {
     DEBUG_FUNC_HEADER("PuzzleDumper::dump(Puzzle&)")
-    std::string values, solution;
-    for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++) {
-        values += std::to_string(puzzle.getValue(cell));
-        solution += std::to_string(puzzle.getSolutionAt(cell));
-        DEBUG_OUTPUT("Cell %d: value=%d; solution=%d", cell, puzzle.getValue(cell), puzzle.getSolutionAt(cell))
-    }
-    DEBUG_OUTPUT("Writing to file: %s, %s", values, solution)
-    std::ofstream file(this->filepath, std::ios_base::app);
-    file << values << ',' << solution << std::endl;
-    file.close();
+    // one character per cell, decoded by PuzzleLoader as the character minus '0'
+    for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++) buffer += '0' + puzzle.getValue(cell);
+    buffer += ',';
+    for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++) buffer += '0' + puzzle.getSolutionAt(cell);
+    buffer += '\n';
+    if (buffer.size() >= SUDOKU_DUMPER_BUFFER_SIZE) flush();
     DEBUG_FUNC_END()
-}
\ No newline at end of file
+}
+
+void PuzzleDumper::flush() {
+    DEBUG_OUTPUT("PuzzleDumper::flush(): writing %d bytes", (int) buffer.size())
+    if (buffer.empty()) return;
+    file.write(buffer.data(), buffer.size());
+    file.flush();
+    buffer.clear();
+}
@@ -0,0 +1,110 @@
+#include <cstring>
+
+#include "difficulty.h"
+#include "candidates.h"
+#include "graph.h"
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+const char * difficultyName(Difficulty difficulty) {
+	switch (difficulty) {
+		case Difficulty::Easy: return "easy";
+		case Difficulty::Medium: return "medium";
+		case Difficulty::Hard: return "hard";
+		case Difficulty::Expert: return "expert";
+		case Difficulty::Invalid: return "invalid";
+	}
+	return "unknown";
+}
+
+Difficulty parseDifficulty(const char *name) {
+	for (Difficulty difficulty : {Difficulty::Easy, Difficulty::Medium, Difficulty::Hard, Difficulty::Expert})
+		if (!strcmp(name, difficultyName(difficulty))) return difficulty;
+	return Difficulty::Invalid;
+}
+
+// Places every naked single of the grid, returning how many were placed
+static unsigned placeNakedSingles(CandidateGrid &grid) {
+	unsigned placed = 0;
+	for (unsigned cell = 0; cell < grid.getSizeSquared(); cell++) {
+		if (grid.getValue(cell)) continue;
+		unsigned mask = grid.candidates(cell);
+		if (mask == 0 || (mask & (mask - 1))) continue;
+		grid.place(cell, __builtin_ctz(mask) + 1);
+		placed++;
+	}
+	return placed;
+}
+
+// Places the first hidden single found in any row, column or box, returning false if there is none
+static bool placeHiddenSingle(CandidateGrid &grid, unsigned ***units) {
+	unsigned size = grid.getSize();
+	for (unsigned ***type = units, ***typeMax = units + 3; type < typeMax; type++) {
+		for (unsigned **unit = *type, **unitMax = unit + size; unit < unitMax; unit++) {
+			unsigned once = 0, twice = 0;
+			for (unsigned *cell = *unit, *cellMax = cell + size; cell < cellMax; cell++) {
+				if (grid.getValue(*cell)) continue;
+				unsigned mask = grid.candidates(*cell);
+				twice |= once & mask;
+				once |= mask;
+			}
+			unsigned hidden = once & ~twice;
+			if (hidden == 0) continue;
+			unsigned bit = hidden & -hidden;
+			for (unsigned *cell = *unit, *cellMax = cell + size; cell < cellMax; cell++) {
+				if (grid.getValue(*cell) || !(grid.candidates(*cell) & bit)) continue;
+				grid.place(*cell, __builtin_ctz(bit) + 1);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+difficulty_t rateDifficulty(const Puzzle &puzzle) {
+	DEBUG_FUNC_HEADER("rateDifficulty(Puzzle&)")
+	difficulty_t rating;
+	rating.level = Difficulty::Invalid;
+	rating.nakedSingles = rating.hiddenSingles = 0;
+	rating.score = 0;
+
+	CandidateGrid grid(puzzle);
+	if (!grid.isConsistent()) {
+		DEBUG_FUNC_END()
+		return rating;
+	}
+
+	// apply the easiest technique which still places a value
+	unsigned ***units = graphNeighborhoods(grid.getSize());
+	while (grid.getNumEmpty()) {
+		unsigned naked = placeNakedSingles(grid);
+		rating.nakedSingles += naked;
+		if (naked) continue;
+		if (!placeHiddenSingle(grid, units)) break;
+		rating.hiddenSingles++;
+	}
+
+	// search from where the singles stalled, which also proves the solution unique
+	unsigned solutions = 1;
+	if (grid.getNumEmpty()) {
+		CandidateSearch search(grid);
+		solutions = search.search(2);
+		rating.search.nodes = search.nodes;
+		rating.search.backtracks = search.backtracks;
+		rating.search.eliminations = search.eliminations;
+	}
+	DEBUG_OUTPUT("%d naked singles, %d hidden singles, %d search nodes", rating.nakedSingles, rating.hiddenSingles,
+		(int) rating.search.nodes)
+
+	if (solutions == 1) {
+		if (rating.search.nodes > 0)
+			rating.level = rating.search.backtracks > DIFFICULTY_EXPERT_BACKTRACKS ? Difficulty::Expert : Difficulty::Hard;
+		else rating.level = rating.hiddenSingles ? Difficulty::Medium : Difficulty::Easy;
+	}
+	rating.score = rating.nakedSingles + DIFFICULTY_HIDDEN_SINGLE_WEIGHT * rating.hiddenSingles
+		+ DIFFICULTY_NODE_WEIGHT * rating.search.nodes + DIFFICULTY_BACKTRACK_WEIGHT * rating.search.backtracks;
+
+	DEBUG_FUNC_END()
+	return rating;
+}
@@ -1,3 +1,5 @@
+#include <mutex>
+
 #include "puzzle.h"
 
 #include "graph.h"
@@ -28,9 +30,13 @@ struct node_t {
     }
 };
 
+// Lookups and additions are not synchronized; callers hold mutex while they 
+// check the cache and build a missing value, so each value is built once even
+// when several solver threads start at the same time
 template<typename Key, typename Val> 
 struct cache_t {
 	node_t<Key, Val> *listHead = nullptr;
+	std::mutex mutex;
 	
 	Val get(Key key, Val defaultValue) {
 		node_t<Key, Val> *cursor = listHead;
@@ -67,7 +73,7 @@ struct cache_t {
 			if (cursor->next == nullptr) break;
 			cursor = cursor->next;
 		}
-		cursor->next = new node_t<Key, Val>(key, val);
+		cursor->next = new node_t<Key, Val>(key, val, valDestructor, valDestructorArgs);
 		return true;
 	}
 
@@ -110,6 +116,7 @@ void utpDestructor(utpArgs* args, unsigned *** val) {
 unsigned *** graphNeighborhoodByCell(unsigned size) {
     DEBUG_FUNC_HEADER("graphNeighborhoodByCell(%d)", size)
     static cache_t<unsigned, unsigned ***> cache;
+    std::lock_guard<std::mutex> lock(cache.mutex);
 
     // check cache for precomputed graph structure
     unsigned *** cachedValue = cache.get(size, nullptr);
@@ -205,6 +212,7 @@ unsigned *** graphNeighborhoodByCell(unsigned size) {
 unsigned *** graphNeighborhoods(unsigned size) {
     DEBUG_FUNC_HEADER("graphNeighborhoods(%d)", size)
     static cache_t<unsigned, unsigned ***> cache;
+    std::lock_guard<std::mutex> lock(cache.mutex);
 
     // check cache for precomputed graph structure
     unsigned ***cachedValue = cache.get(size, nullptr);
@@ -222,13 +230,12 @@ unsigned *** graphNeighborhoods(unsigned size) {
 	// BUILD NEIGHBORHOODS
 	DEBUG_OUTPUT("Building neighborhoods")
 
-    // allocate memory
-	unsigned neighborhoodSize = size - 1;
+    // allocate memory: every neighborhood holds all size of its cells
 	unsigned ***neighborhoods = new unsigned**[numNeighborhoods];
 	for (unsigned ***i = neighborhoods, ***iMax = i + numNeighborhoods; i < iMax; i++) {
 		*i = new unsigned*[size]; 
 		for (unsigned **j = *i, **jMax = j + size; j < jMax; j++) 
-			*j = new unsigned[neighborhoodSize];
+			*j = new unsigned[size];
 	}
 
 	DEBUG_OUTPUT("Memory Allocated")
@@ -240,7 +247,7 @@ unsigned *** graphNeighborhoods(unsigned size) {
         if (col == size) {
             col = 0;
             row++; rowPtr++;
-            cursor = *rowPtr;
+            if (row < size) cursor = *rowPtr;
         }
     }
 
@@ -254,7 +261,7 @@ unsigned *** graphNeighborhoods(unsigned size) {
         if (row == size) {
             row = 0;
             col++; colPtr++;
-            cursor = *colPtr;
+            if (col < size) cursor = *colPtr;
             cell = col;
         }
     }  
@@ -274,7 +281,8 @@ unsigned *** graphNeighborhoods(unsigned size) {
             cell += minorRowUpdate;
             if (minorRow == sizeSqrt) {
                 minorRow = 0; majorCol++;
-                boxPtr++; cursor = *boxPtr;
+                boxPtr++;
+                if (boxPtr < neighborhoods[2] + size) cursor = *boxPtr;
                 cell -= majorColUpdate;
                 if (majorCol == sizeSqrt) {
                     majorCol = 0; majorRow++;
@@ -297,6 +305,7 @@ unsigned *** graphNeighborhoods(unsigned size) {
 unsigned ** graphNeighborsByCell(unsigned size) {
     DEBUG_FUNC_HEADER("graphNeighborsByCell(%d)", size)
     static cache_t<unsigned, unsigned **> cache;
+    std::lock_guard<std::mutex> lock(cache.mutex);
 
     // check cache for precomputed graph structure
     unsigned ** cachedValue = cache.get(size, nullptr);
@@ -349,6 +358,7 @@ unsigned ** graphNeighborsByCell(unsigned size) {
 			if (otherMinorCol == sizeSqrt) {
 				otherMinorCol = 0; otherMinorRow++;
 				otherCell += size - sizeSqrt;
+				if (otherMinorRow == sizeSqrt) break;
 			}
 			if (otherMinorCol != minorCol && otherMinorRow != minorRow) {
 				neighborhoods[cell][neighborOffset++] = otherCell;
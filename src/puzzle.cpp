@@ -165,7 +165,6 @@ Puzzle::Puzzle(unsigned char size, unsigned char **values) {
 Puzzle::Puzzle(const Puzzle &other) {
 	DEBUG_FUNC_HEADER("Puzzle::Puzzle(Puzzle&)")
 	this->initializeSize(other.size);
-	// TODO: handle solution
 	for (int cell = 0; cell < this->sizeSquared; cell++) {
 		DEBUG_STATEMENT(unsigned r = cell / size)
 		DEBUG_STATEMENT(unsigned c = cell % size)
@@ -178,18 +177,20 @@ Puzzle::Puzzle(const Puzzle &other) {
 		  DEBUG_OUTPUT("concrete[%d][%d] == %s", r, c, this->concrete[cell] ? "true" : "false")
 		DEBUG_OUTDENT()
 	}
+	if (other.solution != nullptr) {
+		this->solution = new unsigned char[this->sizeSquared];
+		for (unsigned cell = 0; cell < this->sizeSquared; cell++) this->solution[cell] = other.solution[cell];
+	}
 
 	DEBUG_FUNC_END()
 }
 
 bool Puzzle::setValue(unsigned cell, unsigned char val) {
-	DEBUG_FUNC_HEADER("Puzzle::setValue(%d, %d", cell, val)
-	#ifdef DEBUG_PUZZLE_CPP
-	 std::cout << "Puzzle::setValue(" << cell << ", " << static_cast<int>(val) << ")" << std::endl;
-	#endif
-	DEBUG_OUTPUT_IF(concrete[cell], "Cell is concrete! Cannot reassign!")
+	DEBUG_FUNC_HEADER("Puzzle::setValue(%d, %d)", cell, val)
+	DEBUG_OUTPUT_IF(cell >= this->sizeSquared, "ERROR: Cell %d is out of range!", cell)
+	DEBUG_OUTPUT_IF(cell < this->sizeSquared && concrete[cell], "Cell is concrete! Cannot reassign!")
 	DEBUG_OUTPUT_IF(val > this->size, "ERROR: Value %d is out of range!", val)
-	if (concrete[cell] || val > this->size) {
+	if (cell >= this->sizeSquared || concrete[cell] || val > this->size) {
 		DEBUG_FUNC_END()
 		return false;
 	}
@@ -1,6 +1,12 @@
 #include "solvers.h"
 #include "puzzle.h"
+#include "annealing.h"
 #include <cmath>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
 
 // #define DEBUG_ENABLED
 // #define DEBUG_ENABLED_VERBOSE
@@ -11,102 +17,294 @@ using namespace Solvers;
 /****************************************************************************\
  * TODO
  * - Modular acceptance probability function
- * - Other cooling schedules
- * - Modular markov chain length
- * - Normalize cost function to make temperature settings more predictable
- *   > For example: in the exponential acceptance probability function, 
- *     P(t, Δ) = exp(Δ / t). If Δ is guaranteed in a certain distribution, 
- *     setting the temperature based on target acceptance rates is possible.
 \****************************************************************************/
 
-AnnealingSolver::AnnealingSolver(unsigned reheats, unsigned iterations) {
+#define ANNEAL_CALIBRATION_SAMPLES 256 // swaps sampled to calibrate the initial temperature
+#define ANNEAL_CALIBRATION_ACCEPTANCE 0.8 // calibrated acceptance probability of an average worsening swap
+#define ANNEAL_ADAPTIVE_GAIN 2.0 // temperature response of the adaptive schedule to acceptance errors
+#define ANNEAL_MIN_TEMP 1e-3
+
+AnnealingSolver::AnnealingSolver(unsigned reheats, unsigned iterations, uint64_t seed) : random(seed) {
     this->reheats = reheats;
     this->iterations = iterations;
+    this->acceptanceRate = 1;
+    this->calibratedTemp = 1;
+    this->chainAcceptFraction = 1;
+}
+
+// Precomputes acceptance thresholds for a temperature: a swap which worsens the cost 
+// by k is accepted if a uniform 64-bit sample is below thresholds[k] = 2^64 * exp(-k / t)
+static void computeAcceptanceThresholds(double temperature, uint64_t *thresholds) {
+    thresholds[0] = UINT64_MAX;
+    for (unsigned k = 1; k <= ANNEAL_MAX_DELTA; k++) {
+        double prob = exp(-(k / temperature));
+        thresholds[k] = prob >= 1 ? UINT64_MAX : static_cast<uint64_t>(prob * 18446744073709551616.0);
+    }
+}
+
+// Samples two distinct initially empty cells within a random row
+static inline void sampleSwap(const anneal_state_t &state, Random &random, 
+    unsigned char &row, unsigned char &col1, unsigned char &col2
+) {
+    row = state.swapRows[random.below(state.numSwapRows)];
+    unsigned char numFree = state.numFree[row];
+    unsigned char i1 = random.below(numFree);
+    unsigned char i2 = random.below(numFree - 1);
+    i2 += (i2 >= i1);
+    col1 = state.freeCols[row * state.size + i1];
+    col2 = state.freeCols[row * state.size + i2];
+}
+
+// Kirkpatrick's initial temperature: the temperature at which a worsening swap of
+// average size is accepted with probability ANNEAL_CALIBRATION_ACCEPTANCE
+static double calibrateTemperature(const anneal_state_t &state, Random &random) {
+    unsigned worsening = 0, total = 0;
+    for (unsigned sample = 0; sample < ANNEAL_CALIBRATION_SAMPLES; sample++) {
+        unsigned char row, col1, col2;
+        sampleSwap(state, random, row, col1, col2);
+        int delta = state.swapDelta(row, col1, col2);
+        if (delta > 0) { worsening++; total += delta; }
+    }
+    if (worsening == 0) return 1;
+    return -(static_cast<double>(total) / worsening) / log(ANNEAL_CALIBRATION_ACCEPTANCE);
+}
+
+// Proposes up to count random row swaps at the temperature the thresholds were computed
+// for, stopping early if the state is solved or maxAccepted swaps were accepted. 
+// Returns the number of accepted swaps, and the number proposed through proposed.
+static unsigned annealChain(anneal_state_t &state, Random &random, const uint64_t *thresholds, 
+    unsigned count, unsigned maxAccepted, unsigned &proposed
+) {
+    unsigned accepted = 0, it = 0;
+    for ( ; it < count && accepted < maxAccepted; it++) {
+        // sample two distinct initially empty cells within a random row
+        unsigned char row, col1, col2;
+        sampleSwap(state, random, row, col1, col2);
+
+        // calculate change in conflicts without performing the swap
+        int delta = -state.swapDelta(row, col1, col2);
+
+        // sample acceptance probability exp(delta / temperature), only writing accepted swaps
+        if (delta >= 0 || random.next() < thresholds[-delta]) {
+            state.swap(row, col1, col2, -delta);
+            accepted++;
+            if (state.cost == 0) { it++; break; }
+        }
+    }
+    proposed = it;
+    return accepted;
+}
 
-    srand(time(NULL));
+// Markov chain length: the square of the number of empty cells
+static unsigned computeChainLength(const Puzzle &puzzle) {
+    unsigned chainLength = puzzle.getSizeSquared();
+    for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++) chainLength -= puzzle.isConcrete(cell);
+    return chainLength * chainLength;
 }
 
 void AnnealingSolver::solve(Puzzle &puzzle) {
     DEBUG_FUNC_HEADER("AnnealingSolver::solve(Puzzle &)")
+    TRACE_BEGIN(TRACE_SOLVE, 0, 0)
 
     // calculate the markov chain length
-    unsigned chainLength = puzzle.getSizeSquared();
-    for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++) chainLength -= puzzle.isConcrete(cell);
-    chainLength = chainLength * chainLength;
-    unsigned iterations = chainLength * this->iterations;
+    unsigned chainLength = computeChainLength(puzzle);
 
-    DEBUG_OUTPUT("Preparing %d heats of %d iterations", this->reheats, iterations)
+    DEBUG_OUTPUT("Preparing %d heats of %d chains", this->reheats, this->iterations)
     DEBUG_OUTPUT("Markov chain length: %d", chainLength)
     DEBUG_OUTPUT("Initilizing empty cells...")
 
     // initialize the puzzle so each row has every value
-    for (unsigned char row = 0; row < puzzle.getSize(); row++) {
-        unsigned char val = 1;
-        unsigned rowOffset = row * puzzle.getSize();
-        for (unsigned cell = rowOffset; cell < rowOffset + puzzle.getSize(); cell++)
-            if (!puzzle.isConcrete(cell)) {
-                do {
-                    puzzle.setValue(cell, val++);
-                } while (puzzle.hasConflictInRow(row));
-            }
+    anneal_state_t state(puzzle);
+    solve_budget_t budget(options);
+    if (state.numSwapRows == 0) {
+        // no swaps are possible, so the initial state is the only candidate
+        state.writeTo(puzzle);
+        status = state.cost == 0 ? SolveStatus::Solved : SolveStatus::Unsolvable;
+        TRACE_END(TRACE_SOLVE, 0, puzzle.isSolved())
+        DEBUG_FUNC_END()
+        return;
     }
 
     // begin simulated annealing
-    double temperature;
-    for (unsigned heat = 0; heat < reheats && !puzzle.isSolved(); heat++) {
-        // Perform one heating iteration
-        for (unsigned it = 0; it < iterations; it++) {
-            // progress through temperature schedule after each chain-length
-            if (it % chainLength == 0) {
-                if (puzzle.isSolved()) return;
-                temperature = this->tempSchedule(it, temperature);
+    this->calibratedTemp = calibrateTemperature(state, random);
+    unsigned maxAccepted = std::max(1U, static_cast<unsigned>(chainLength * chainAcceptFraction));
+    DEBUG_OUTPUT("Calibrated initial temperature: %f", this->calibratedTemp)
+    double temperature = 0;
+    uint64_t thresholds[ANNEAL_MAX_DELTA + 1];
+    for (unsigned heat = 0; heat < reheats && state.cost > 0 && !budget.stopped(); heat++) {
+        // Perform one heating iteration, progressing through the temperature schedule after each chain
+        STATS_INC(stats, reheats)
+        TRACE_BEGIN(TRACE_HEAT, 0, state.cost)
+        this->acceptanceRate = 1;
+        for (unsigned chain = 0; chain < this->iterations && state.cost > 0 && !budget.stopped(); chain++) {
+            temperature = this->tempSchedule(chain, temperature);
+            computeAcceptanceThresholds(temperature, thresholds);
+            unsigned proposed;
+            unsigned accepted = annealChain(state, random, thresholds, chainLength, maxAccepted, proposed);
+            this->acceptanceRate = static_cast<double>(accepted) / proposed;
+            STATS_ADD(stats, movesProposed, proposed)
+            STATS_ADD(stats, movesAccepted, accepted)
+            budget.spendAndCheck(proposed);
+        }
+        TRACE_END(TRACE_HEAT, 0, state.cost)
+        DEBUG_OUTPUT("Heat %d: final conflict count is %d", heat, state.cost)
+    }
+
+    state.writeTo(puzzle);
+    if (state.cost == 0) status = SolveStatus::Solved;
+    else status = budget.stopped() ? budget.status : SolveStatus::Unsolved;
+    TRACE_END(TRACE_SOLVE, 0, puzzle.isSolved())
+    DEBUG_FUNC_END()
+}
+
+// Reusable thread barrier: the last thread to arrive runs the completion step
+// before any thread is released
+typedef struct barrier_t {
+    std::mutex mutex;
+    std::condition_variable released;
+    const unsigned count;
+    unsigned waiting;
+    unsigned long generation;
+
+    barrier_t(unsigned count) : count(count), waiting(0), generation(0) {};
+
+    template <typename Completion>
+    void arriveAndWait(Completion completion) {
+        std::unique_lock<std::mutex> lock(mutex);
+        unsigned long arrivalGeneration = generation;
+        if (++waiting == count) {
+            completion();
+            waiting = 0;
+            generation++;
+            released.notify_all();
+            return;
+        }
+        released.wait(lock, [&]{ return generation != arrivalGeneration; });
+    }
+} barrier_t;
+
+ParallelTemperingSolver::ParallelTemperingSolver(unsigned replicas, unsigned iterations, double initialTemp, 
+    double tempFactor, unsigned exchangeInterval, uint64_t seed) :
+    AnnealingSolver(1, iterations, seed), GeometricAnnealingSolver(1, iterations, initialTemp, tempFactor, seed),
+    replicas(replicas ? replicas : std::max(2U, std::thread::hardware_concurrency())), 
+    exchangeInterval(exchangeInterval ? exchangeInterval : 1) {}
+
+void ParallelTemperingSolver::solve(Puzzle &puzzle) {
+    DEBUG_FUNC_HEADER("ParallelTemperingSolver::solve(Puzzle &)")
+    TRACE_BEGIN(TRACE_SOLVE, 0, 0)
+    unsigned chainLength = computeChainLength(puzzle);
+    unsigned rounds = (this->iterations + exchangeInterval - 1) / exchangeInterval;
+
+    // every replica starts from the same state but draws its own random stream
+    std::vector<anneal_state_t *> states(replicas);
+    std::vector<Random> randoms;
+    std::vector<unsigned> slotOf(replicas), replicaAt(replicas);
+    for (unsigned replica = 0; replica < replicas; replica++) {
+        states[replica] = new anneal_state_t(puzzle);
+        randoms.emplace_back(this->random.next());
+        slotOf[replica] = replicaAt[replica] = replica;
+    }
+    if (states[0]->numSwapRows) this->calibratedTemp = calibrateTemperature(*states[0], this->random);
+
+    // temperature ladder from the geometric schedule, hottest first
+    std::vector<double> temperatures(replicas);
+    for (unsigned slot = 0; slot < replicas; slot++)
+        temperatures[slot] = this->tempSchedule(slot, slot ? temperatures[slot - 1] : 0);
+
+    if (states[0]->numSwapRows == 0 || states[0]->cost == 0) rounds = 0;
+    DEBUG_OUTPUT("Running %d replicas for %d rounds of %d chains", replicas, rounds, exchangeInterval)
+
+    // attempt exchanges between neighboring temperatures, alternating even and odd pairs
+    unsigned round = 0;
+    bool done = rounds == 0;
+    solve_budget_t budget(options);
+    std::vector<uint64_t> roundProposals(replicas); // charged to the budget at every exchange
+    auto exchange = [&]() {
+        for (unsigned replica = 0; replica < replicas && !done; replica++) done = states[replica]->cost == 0;
+        uint64_t proposals = 0;
+        for (uint64_t &count : roundProposals) { proposals += count; count = 0; }
+        if (done || ++round >= rounds || budget.spendAndCheck(proposals)) { done = true; return; }
+        TRACE_INSTANT(TRACE_EXCHANGE, 0, round)
+        for (unsigned slot = round % 2; slot + 1 < replicas; slot += 2) {
+            unsigned hot = replicaAt[slot], cold = replicaAt[slot + 1];
+            double exponent = (1 / temperatures[slot + 1] - 1 / temperatures[slot]) * 
+                (static_cast<double>(states[cold]->cost) - states[hot]->cost);
+            if (exponent >= 0 || this->random.uniform() < exp(exponent)) {
+                std::swap(replicaAt[slot], replicaAt[slot + 1]);
+                slotOf[hot] = slot + 1;
+                slotOf[cold] = slot;
             }
+        }
+    };
 
-            // sample random row
-            unsigned char row = rand() % puzzle.getSize();
-            unsigned rowOffset = row * puzzle.getSize();
-
-            // sample cells within the identified row that were initially empty
-            unsigned char col1 = rand() % puzzle.getSize();
-            for (unsigned char ctr = 0; puzzle.isConcrete(rowOffset+col1) && ctr < puzzle.getSize(); ctr++) col1 = ++col1 % puzzle.getSize();
-            unsigned char col2 = rand() % puzzle.getSize();
-            for (unsigned char ctr = 0; puzzle.isConcrete(rowOffset+col2) && ctr < puzzle.getSize(); ctr++) col2 = ++col2 % puzzle.getSize();
-            unsigned cell1 = rowOffset + col1;
-            unsigned cell2 = rowOffset + col2;
-
-            // do not attempt swap if either cell was not initially empty, or the same cell was sampled twice
-            if (puzzle.isConcrete(cell1) || puzzle.isConcrete(cell2) || cell1 == cell2) continue;
-
-            // calculate change in conflicts
-            int delta = puzzle.numConflictsAt(cell1) + puzzle.numConflictsAt(cell2);
-            unsigned char temp = puzzle.getValue(cell1);
-            puzzle.setValue(cell1, puzzle.getValue(cell2));
-            puzzle.setValue(cell2, temp);
-            delta -= puzzle.numConflictsAt(cell1) + puzzle.numConflictsAt(cell2);
-
-            // calculate acceptance probability
-            double prob = exp(delta / temperature);
-
-            // sample acceptance probability
-            DEBUG_STATEMENT(bool debugvar_swapped = true)
-            // bool debugvar_swapped = true;
-            if (static_cast<double>(rand()) / RAND_MAX > prob) {
-                // undo cell swap if change was not accepted
-                DEBUG_STATEMENT(debugvar_swapped = false;)
-                unsigned char temp = puzzle.getValue(cell1);
-                puzzle.setValue(cell1, puzzle.getValue(cell2));
-                puzzle.setValue(cell2, temp);
+    // each replica counts its own moves, merged once the threads are joined
+    barrier_t barrier(replicas);
+    std::vector<solver_stats_t> replicaStats(replicas);
+    auto run = [&](unsigned replica) {
+        anneal_state_t &state = *states[replica];
+        uint64_t thresholds[ANNEAL_MAX_DELTA + 1];
+        unsigned proposed;
+        while (!done) {
+            computeAcceptanceThresholds(temperatures[slotOf[replica]], thresholds);
+            for (unsigned chain = 0; chain < exchangeInterval && state.cost > 0; chain++) {
+                unsigned accepted = annealChain(state, randoms[replica], thresholds, chainLength, chainLength, proposed);
+                roundProposals[replica] += proposed;
+                STATS_ADD(replicaStats[replica], movesProposed, proposed)
+                STATS_ADD(replicaStats[replica], movesAccepted, accepted)
             }
-            DEBUG_OUTPUT("Iteration %d: Attempt to swap columns %d and %d of row %d with delta %d %s", 
-                         it, col1, col2, row, delta, debugvar_swapped ? "succeeded" : "failed")
+            barrier.arriveAndWait(exchange);
         }
-        DEBUG_OUTPUT("Heat %d: final conflict count is %d", heat, puzzle.numConflicts())
-    }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned replica = 1; replica < replicas && !done; replica++) threads.emplace_back(run, replica);
+    run(0);
+    for (std::thread &thread : threads) thread.join();
+    for (solver_stats_t &counts : replicaStats) this->stats += counts;
+
+    // keep the best replica, preferring the lowest index among equals so results are reproducible
+    anneal_state_t *best = states[0];
+    for (anneal_state_t *state : states) if (state->cost < best->cost) best = state;
+    DEBUG_OUTPUT("Best replica finished with %d conflicts", best->cost)
+    best->writeTo(puzzle);
+    if (best->cost == 0) status = SolveStatus::Solved;
+    else if (best->numSwapRows == 0) status = SolveStatus::Unsolvable;
+    else status = budget.stopped() ? budget.status : SolveStatus::Unsolved;
+
+    for (anneal_state_t *state : states) delete state;
+    TRACE_END(TRACE_SOLVE, 0, puzzle.isSolved())
     DEBUG_FUNC_END()
 }
 
-double GeometricAnnealingSolver::tempSchedule(unsigned iteration, double temperature) {
-    DEBUG_OUTPUT("GeometricAnnealingSolver::tempSchedule(%d, %f) = %f", iteration, temperature, 
-                 iteration == 0 ? tempInit : temperature * tempFact)
-    return iteration == 0 ? tempInit : temperature * tempFact;
-}
\ No newline at end of file
+double GeometricAnnealingSolver::tempSchedule(unsigned chain, double temperature) {
+    DEBUG_OUTPUT("GeometricAnnealingSolver::tempSchedule(%d, %f)", chain, temperature)
+    return chain == 0 ? initialTemperature(tempInit) : temperature * tempFact;
+}
+
+double LinearAnnealingSolver::tempSchedule(unsigned chain, double /*temperature*/) {
+    DEBUG_OUTPUT("LinearAnnealingSolver::tempSchedule(%d)", chain)
+    double start = initialTemperature(tempInit);
+    if (this->iterations < 2) return start;
+    return std::max(ANNEAL_MIN_TEMP, start + (tempFinal - start) * chain / (this->iterations - 1));
+}
+
+double LogarithmicAnnealingSolver::tempSchedule(unsigned chain, double /*temperature*/) {
+    DEBUG_OUTPUT("LogarithmicAnnealingSolver::tempSchedule(%d)", chain)
+    return initialTemperature(tempInit) * M_LN2 / log(chain + 2.);
+}
+
+double LundyMeesAnnealingSolver::tempSchedule(unsigned chain, double temperature) {
+    DEBUG_OUTPUT("LundyMeesAnnealingSolver::tempSchedule(%d, %f)", chain, temperature)
+    return chain == 0 ? initialTemperature(tempInit) : temperature / (1 + beta * temperature);
+}
+
+double AdaptiveAnnealingSolver::tempSchedule(unsigned chain, double temperature) {
+    DEBUG_OUTPUT("AdaptiveAnnealingSolver::tempSchedule(%d, %f) with acceptance rate %f", chain, temperature, acceptanceRate)
+    if (chain == 0) {
+        target = targetInit;
+        return initialTemperature(tempInit);
+    }
+    // the acceptance rate was measured for the target of the previous chain
+    double error = target - acceptanceRate;
+    target *= targetDecay;
+    return std::max(ANNEAL_MIN_TEMP, temperature * exp(ANNEAL_ADAPTIVE_GAIN * error));
+}
@@ -7,11 +7,34 @@
 // #define DEBUG_ENABLED_VERBOSE
 #include "debugging.h"
 
+Solvers::solve_result_t Solvers::Solver::solve(Puzzle &puzzle, const solve_options_t &options) {
+    solver_stats_t before = stats;
+    this->options = options;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    solve(puzzle);
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    this->options = solve_options_t();
+
+    solve_result_t result {status, puzzle.getValues(), stats, elapsed};
+    result.stats -= before;
+    return result;
+}
+
+void Solvers::Solver::solveBatch(Puzzle *puzzles, unsigned count, SolveStatus *statuses) {
+    for (unsigned i = 0; i < count; i++) {
+        solve(puzzles[i]);
+        if (statuses) statuses[i] = status;
+    }
+}
+
 void Solvers::DepthFirstSolverV1::solve(Puzzle &puzzle) {
     DEBUG_FUNC_HEADER("Solvers::DepthFirstSolverV1::solve(Puzzle&)")
+    TRACE_BEGIN(TRACE_SOLVE, 0, 0)
 
     // Reset puzzle if provided with conflict
     if (puzzle.hasConflict()) puzzle.reset();
+    solve_budget_t budget(options);
+    status = SolveStatus::Running;
 
     // Initilize stacktracing vectors
     unsigned cursor = 0;
@@ -21,11 +44,8 @@ void Solvers::DepthFirstSolverV1::solve(Puzzle &puzzle) {
     guesses.reserve(puzzle.getSizeSquared());
 
     // Search
-    while (!puzzle.isSolved()) {
-        DEBUG_OUTPUT("Cursor at row %d and column %d", cursor / puzzle.getSize(), cursor % puzzle.getSize())
-        
+    while (!puzzle.isSolved() && !budget.spend()) {
         if (puzzle.hasConflict()) {
-            DEBUG_OUTPUT("Attempting to resolve conflict...")
             unsigned char guess = puzzle.getSize() + 1;
             while (guess > puzzle.getSize() && !guesses.empty()) {
                 cursor = cells.back();
@@ -33,39 +53,53 @@ void Solvers::DepthFirstSolverV1::solve(Puzzle &puzzle) {
                 guess = guesses.back() + 1;
                 guesses.pop_back();
                 // clear cell
-                puzzle.setValue(cursor, 0);
+                puzzle.setValueUnchecked(cursor, 0);
+                STATS_INC(stats, backtracks)
+                TRACE_INSTANT(TRACE_BACKTRACK, cursor, guess)
             }
-            DEBUG_OUTPUT("Setting cell at row %d and column %d to %d", cursor / puzzle.getSize(), cursor % puzzle.getSize(), guess)
-            // NOTE ON ABOVE: if guess is not printing properly, try immediately transforming to string using std::to_string
             if (guess <= puzzle.getSize()) {
-                puzzle.setValue(cursor, guess);
+                puzzle.setValueUnchecked(cursor, guess);
                 cells.push_back(cursor);
                 guesses.push_back(guess);
+                STATS_INC(stats, nodes)
+            }
+            else {
+                // every guess was tried, or the givens conflict
+                status = SolveStatus::Unsolvable;
+                break;
             }
         }
         else if (!puzzle.isConcrete(cursor)) {
-            DEBUG_OUTPUT("Setting cell at row %d and column %d to 1", cursor / puzzle.getSize(), cursor % puzzle.getSize())
-            puzzle.setValue(cursor, 1);
+            STATS_INC(stats, nodes)
+            puzzle.setValueUnchecked(cursor, 1);
             cells.push_back(cursor);
             guesses.push_back(1);
         }
-        else if (cursor + 1 >= puzzle.getSizeSquared()) 
-            #ifdef DEBUG_BASIC_SOLVERS_CPP_VERBOSE
-            {
-                std::cout << "ERROR: Cursor exceeded sudoku with neither conflict nor solution...\n";
-                break;
-            }
-            #else
-                break;
-            #endif
+        else if (cursor + 1 >= puzzle.getSizeSquared()) {
+            DEBUG_OUTPUT("ERROR: Cursor exceeded sudoku with neither conflict nor solution...")
+            status = SolveStatus::Unsolved;
+            break;
+        }
         cursor++;
     }
+    if (status == SolveStatus::Running) status = budget.stopped() ? budget.status : SolveStatus::Solved;
 
+    TRACE_END(TRACE_SOLVE, 0, puzzle.isSolved())
     DEBUG_FUNC_END()
 }
 
 void Solvers::DepthFirstSolver::solve(Puzzle &puzzle) {
     DEBUG_FUNC_HEADER("Solvers::DepthFirstSolver::solve(Puzzle&)")
+    TRACE_BEGIN(TRACE_SOLVE, 0, 0)
+    // kept local: writes to the puzzle could otherwise alias the member in the loop
+    solve_budget_t budget(options);
+    SolveStatus result = SolveStatus::Running;
+    if (puzzle.hasConflict()) {
+        // conflicting givens, or values left by an earlier solve
+        puzzle.reset();
+        if (puzzle.hasConflict()) result = SolveStatus::Unsolvable;
+    }
+
     // Initilize stacktracing vectors
     std::vector<unsigned> cells;
     cells.reserve(puzzle.getSizeSquared());
@@ -75,12 +109,11 @@ void Solvers::DepthFirstSolver::solve(Puzzle &puzzle) {
     // Search
     unsigned node = 0;
     unsigned char guess = 1;
-    while (node < puzzle.getSizeSquared()) {
-        DEBUG_OUTPUT("Cursor at row %d and column %d", node / puzzle.getSize(), node % puzzle.getSize())
+    while (result == SolveStatus::Running && node < puzzle.getSizeSquared() && !budget.spend()) {
         if (!puzzle.isConcrete(node)) {
             do {
-                DEBUG_OUTPUT("Setting cell at row %d and column %d to %d", node / puzzle.getSize(), node % puzzle.getSize(), guess)
-                puzzle.setValue(node, guess);
+                STATS_INC(stats, nodes)
+                puzzle.setValueUnchecked(node, guess);
             } while (puzzle.hasConflictAt(node) && guess++ < puzzle.getSize());
 
             if (guess <= puzzle.getSize()) {
@@ -90,17 +123,28 @@ void Solvers::DepthFirstSolver::solve(Puzzle &puzzle) {
             } else {
                 while (guess > puzzle.getSize() && !guesses.empty()) {
                     // clear cell
-                    DEBUG_OUTPUT("Clearing cell at row %d and column %d", node / puzzle.getSize(), node % puzzle.getSize())
-                    puzzle.setValue(node, 0);
+                    STATS_INC(stats, backtracks)
+                    TRACE_INSTANT(TRACE_BACKTRACK, node, guess)
+                    puzzle.setValueUnchecked(node, 0);
                     // backtrack
                     node = cells.back();
                     cells.pop_back();
                     guess = guesses.back() + 1;
                     guesses.pop_back();
                 }
+                if (guess > puzzle.getSize()) {
+                    // every guess of the first empty cell was tried
+                    puzzle.setValueUnchecked(node, 0);
+                    result = SolveStatus::Unsolvable;
+                }
             }
         } else node++;
     }
+    // only a search which placed every cell found a solution
+    if (result == SolveStatus::Running) result = node == puzzle.getSizeSquared() ? SolveStatus::Solved :
+        budget.stopped() ? budget.status : SolveStatus::Unsolved;
+    status = result;
 
+    TRACE_END(TRACE_SOLVE, 0, puzzle.isSolved())
     DEBUG_FUNC_END()
 }
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include "solvers.h"
+#include "puzzle.h"
+#include "graph.h"
+#include "candidates.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+using namespace Solvers;
+
+/*******************************************************\
+ * Lanes: one candidate mask per puzzle of a batch
+\*******************************************************/
+
+#if defined(SUDOKU_SIMD_ENABLED) && defined(__GNUC__)
+// one vector register: 16 lanes with AVX2, 8 with SSE2 or NEON
+typedef uint16_t lanes_t __attribute__((vector_size(2 * BATCH_LANES)));
+
+static inline lanes_t broadcast(uint16_t value) { return lanes_t{} + value; }
+static inline lanes_t isZero(lanes_t lanes) { return (lanes_t) (lanes == 0); }
+#else
+typedef struct lanes_t {
+    uint16_t lane[BATCH_LANES] = {};
+
+    uint16_t &operator[](unsigned i) { return lane[i]; }
+    uint16_t operator[](unsigned i) const { return lane[i]; }
+} lanes_t;
+
+#define LANES_OPERATOR(op) \
+    static inline lanes_t operator op(lanes_t a, lanes_t b) \
+        { for (unsigned i = 0; i < BATCH_LANES; i++) a.lane[i] op##= b.lane[i]; return a; } \
+    static inline lanes_t &operator op##=(lanes_t &a, lanes_t b) \
+        { for (unsigned i = 0; i < BATCH_LANES; i++) a.lane[i] op##= b.lane[i]; return a; }
+LANES_OPERATOR(&)
+LANES_OPERATOR(|)
+LANES_OPERATOR(^)
+
+static inline lanes_t operator~(lanes_t a)
+    { for (unsigned i = 0; i < BATCH_LANES; i++) a.lane[i] = ~a.lane[i]; return a; }
+static inline lanes_t operator-(lanes_t a, uint16_t b)
+    { for (unsigned i = 0; i < BATCH_LANES; i++) a.lane[i] -= b; return a; }
+static inline lanes_t broadcast(uint16_t value)
+    { lanes_t lanes; for (unsigned i = 0; i < BATCH_LANES; i++) lanes.lane[i] = value; return lanes; }
+static inline lanes_t isZero(lanes_t lanes)
+    { for (unsigned i = 0; i < BATCH_LANES; i++) lanes.lane[i] = lanes.lane[i] ? 0 : 0xFFFF; return lanes; }
+#endif
+
+// Lanes of a where mask is set, and of b elsewhere
+static inline lanes_t select(lanes_t mask, lanes_t a, lanes_t b) { return (a & mask) | (b & ~mask); }
+
+static inline bool any(const lanes_t &lanes) {
+    uint64_t words[sizeof(lanes_t) / sizeof(uint64_t)], found = 0;
+    memcpy(words, &lanes, sizeof(lanes_t));
+    for (uint64_t word : words) found |= word;
+    return found;
+}
+
+/*******************************************************\
+ * BatchSolver
+\*******************************************************/
+
+// Searches a puzzle from its values (or only its givens), filling it in if a solution is found
+static SolveStatus searchLane(Puzzle &puzzle, bool givensOnly, const solve_options_t &options, solver_stats_t &stats) {
+    CandidateGrid grid(puzzle, givensOnly);
+    if (!grid.isConsistent()) {
+        puzzle.reset();
+        return SolveStatus::Unsolvable;
+    }
+    solve_budget_t budget(options);
+    CandidateSearch search(grid);
+    search.limit(&budget);
+    unsigned char solution[puzzle.getSizeSquared()];
+    SolveStatus status;
+    if (search.search(1, solution)) {
+        for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++)
+            if (!puzzle.isConcrete(cell)) puzzle.setValueUnchecked(cell, solution[cell]);
+        status = SolveStatus::Solved;
+    }
+    else if (budget.stopped()) status = budget.status;
+    else {
+        puzzle.reset();
+        status = SolveStatus::Unsolvable;
+    }
+    STATS_ADD(stats, nodes, search.nodes)
+    STATS_ADD(stats, backtracks, search.backtracks)
+    STATS_ADD(stats, eliminations, search.eliminations)
+    return status;
+}
+
+// Solves up to BATCH_LANES puzzles of the same size, propagating singles in every lane at once
+static void solveLanes(Puzzle *puzzles, unsigned count, SolveStatus *statuses, const solve_options_t &options, solver_stats_t &stats) {
+    DEBUG_FUNC_HEADER("solveLanes(%u puzzles)", count)
+    const unsigned char size = puzzles[0].getSize();
+    const unsigned sizeSquared = size * size;
+    const uint16_t fullMask = (1U << size) - 1;
+    unsigned ***units = graphNeighborhoods(size);
+
+    // unused lanes stay empty, which reads as a contradiction
+    std::vector<lanes_t> candidates(sizeSquared);
+    lanes_t active = {}, dead = {};
+    for (unsigned lane = 0; lane < count; lane++) {
+        active[lane] = 0xFFFF;
+        for (unsigned cell = 0; cell < sizeSquared; cell++)
+            candidates[cell][lane] = puzzles[lane].isConcrete(cell) ? CANDIDATE_BIT(puzzles[lane].getValue(cell)) : fullMask;
+    }
+
+    // every sweep removes the values fixed in a unit from its other cells, and fixes the
+    // values with one place left in a unit, until no live lane changes
+    const lanes_t full = broadcast(fullMask);
+    bool changed = true;
+    while (changed) {
+        STATS_INC(stats, iterations)
+        lanes_t changes = {};
+        for (unsigned type = 0; type < 3; type++) {
+            for (unsigned unit = 0; unit < size; unit++) {
+                const unsigned *cells = units[type][unit];
+                lanes_t once = {}, twice = {}, fixed = {}, fixedTwice = {};
+                for (unsigned i = 0; i < size; i++) {
+                    lanes_t mask = candidates[cells[i]];
+                    lanes_t single = mask & isZero(mask & (mask - 1));
+                    fixedTwice |= fixed & single;
+                    fixed |= single;
+                    twice |= once & mask;
+                    once |= mask;
+                }
+                dead |= ~isZero(fixedTwice) | ~isZero(once ^ full);
+
+                lanes_t hidden = once & ~twice & ~fixed;
+                for (unsigned i = 0; i < size; i++) {
+                    lanes_t mask = candidates[cells[i]];
+                    lanes_t remaining = mask & ~fixed;
+                    lanes_t forced = remaining & hidden;
+                    remaining = select(isZero(forced), remaining, forced);
+                    remaining = select(isZero(mask & (mask - 1)), mask, remaining);
+                    dead |= ~isZero(forced & (forced - 1)) | isZero(remaining);
+                    changes |= remaining ^ mask;
+                    candidates[cells[i]] = remaining;
+                }
+            }
+        }
+        changed = any(changes & active & ~dead);
+    }
+
+    // write back the fixed cells, and search the lanes still open one at a time
+    for (unsigned lane = 0; lane < count; lane++) {
+        Puzzle &puzzle = puzzles[lane];
+        if (dead[lane]) {
+            puzzle.reset();
+            statuses[lane] = SolveStatus::Unsolvable;
+            continue;
+        }
+        unsigned open = 0;
+        for (unsigned cell = 0; cell < sizeSquared; cell++) {
+            if (puzzle.isConcrete(cell)) continue;
+            unsigned mask = candidates[cell][lane];
+            if (mask & (mask - 1)) {
+                puzzle.setValueUnchecked(cell, 0);
+                open++;
+            }
+            else {
+                puzzle.setValueUnchecked(cell, __builtin_ctz(mask) + 1);
+                STATS_INC(stats, collapses)
+            }
+        }
+        DEBUG_OUTPUT("Lane %u: %u cells open after propagation", lane, open)
+        statuses[lane] = open ? searchLane(puzzle, false, options, stats) : SolveStatus::Solved;
+    }
+    DEBUG_FUNC_END()
+}
+
+void BatchSolver::solve(Puzzle &puzzle) {
+    DEBUG_FUNC_HEADER("BatchSolver::solve(Puzzle &puzzle)")
+    solveBatch(&puzzle, 1, &status);
+    DEBUG_FUNC_END()
+}
+
+void BatchSolver::solveBatch(Puzzle *puzzles, unsigned count, SolveStatus *statuses) {
+    DEBUG_FUNC_HEADER("BatchSolver::solveBatch(%u puzzles)", count)
+    TRACE_BEGIN(TRACE_SOLVE, 0, 0)
+    std::vector<SolveStatus> kept;
+    if (!statuses) {
+        kept.resize(count);
+        statuses = kept.data();
+    }
+
+    // a batch takes the next run of up to BATCH_LANES puzzles of the same size
+    for (unsigned first = 0, end; first < count; first = end) {
+        unsigned char size = puzzles[first].getSize();
+        end = first + 1;
+        if (size > BATCH_MAX_SIZE || puzzles[first].getSizeSqrt() * puzzles[first].getSizeSqrt() != size) {
+            statuses[first] = searchLane(puzzles[first], true, options, stats);
+            continue;
+        }
+        while (end < count && end - first < BATCH_LANES && puzzles[end].getSize() == size) end++;
+        solveLanes(puzzles + first, end - first, statuses + first, options, stats);
+    }
+
+    unsigned solved = 0;
+    for (unsigned i = 0; i < count; i++) solved += statuses[i] == SolveStatus::Solved;
+    if (count) status = statuses[count - 1];
+    TRACE_END(TRACE_SOLVE, 0, solved == count)
+    DEBUG_FUNC_END()
+}
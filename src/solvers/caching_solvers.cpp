@@ -0,0 +1,35 @@
+#include "solvers.h"
+#include "puzzle.h"
+#include "canonical.h"
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+void Solvers::CachingSolver::solve(Puzzle &puzzle) {
+    DEBUG_FUNC_HEADER("Solvers::CachingSolver::solve(Puzzle&)")
+    unsigned char size = puzzle.getSize();
+    unsigned sizeSquared = size * size;
+    unsigned char givens[sizeSquared], canonicalSolution[sizeSquared], solution[sizeSquared];
+    for (unsigned cell = 0; cell < sizeSquared; cell++) givens[cell] = puzzle.isConcrete(cell) ? puzzle.getValue(cell) : 0;
+    canonical_form_t form = canonicalize(size, givens);
+
+    if (cache->lookup(form, canonicalSolution)) {
+        DEBUG_OUTPUT("Cache hit on %016llx", (unsigned long long) form.hash)
+        form.transform.inverse().apply(canonicalSolution, solution);
+        for (unsigned cell = 0; cell < sizeSquared; cell++)
+            if (!puzzle.isConcrete(cell)) puzzle.setValueUnchecked(cell, solution[cell]);
+        status = SolveStatus::Solved;
+        DEBUG_FUNC_END()
+        return;
+    }
+
+    status = inner->solve(puzzle, options).status;
+    stats += inner->getStats();
+    inner->resetStats();
+    if (status == SolveStatus::Solved) {
+        for (unsigned cell = 0; cell < sizeSquared; cell++) solution[cell] = puzzle.getValue(cell);
+        form.transform.apply(solution, canonicalSolution);
+        cache->insert(form, canonicalSolution);
+    }
+    DEBUG_FUNC_END()
+}
@@ -1,6 +1,8 @@
 #include "solvers.h"
 #include "puzzle.h"
 #include "graph.h"
+#include "candidates.h"
+#include <cmath>
 
 
 // #define DEBUG_ENABLED
@@ -9,7 +11,30 @@
 
 using namespace Solvers;
 
+const char * Solvers::graphTerminationName(GraphTermination termination) {
+    switch (termination) {
+        case GraphTermination::Running: return "running";
+        case GraphTermination::Solved: return "solved";
+        case GraphTermination::Converged: return "converged";
+        case GraphTermination::Oscillating: return "oscillating";
+        case GraphTermination::Stagnated: return "stagnated";
+        case GraphTermination::IterationLimit: return "iteration limit";
+    }
+    return "unknown";
+}
+
 #define COLLAPSE_THRESHOLD 0.95
+#define CONVERGENCE_EPSILON 1e-9 // largest coordinate displacement of a converged state
+#define CONVERGENCE_STAGNATION_WINDOW 25 // stagnant iterations in a row before giving up
+#define CONVERGENCE_STAGNATION_DELTA 1e-3 // largest coordinate displacement of a stagnant iteration
+#define CONVERGENCE_HISTORY 8 // longest oscillation period detected
+#define CONVERGENCE_QUANTUM 1e6 // coordinates are compared at this resolution
+
+// Status of a graph collapse which stopped with termination, or hit a limit of budget
+static SolveStatus graphSolveStatus(GraphTermination termination, const solve_budget_t &budget) {
+    if (termination == GraphTermination::Solved) return SolveStatus::Solved;
+    return budget.stopped() ? budget.status : SolveStatus::Unsolved;
+}
 
 typedef struct simplex_data_t {
     double *position;
@@ -107,6 +132,18 @@ typedef struct simplex_data_t {
         for (double *val = position; val < positionEnd; val++) *val = barycenterVal;
     }
     
+    // adds the update vector, reconstrains to the simplex and returns the largest coordinate displacement
+    double step(const simplex_data_t &update) {
+        double previous[ndims];
+        for (double *val = position, *prev = previous; val < positionEnd; val++, prev++) *prev = *val;
+        *this += update;
+        constrainSimplex();
+        double delta = 0;
+        for (double *val = position, *prev = previous; val < positionEnd; val++, prev++)
+            if (std::fabs(*val - *prev) > delta) delta = std::fabs(*val - *prev);
+        return delta;
+    }
+    
     bool collapse() {
         // if (this->value && this->position[this->value - 1] > COLLAPSE_THRESHOLD) return 0;
         for (double *val = position, dim = 0; dim < ndims; dim++, val++) 
@@ -135,8 +172,67 @@ namespace std {
     }
 }
 
+// Tracks the progress of a collapse procedure so it can stop as soon as further
+// iterations cannot change the outcome, rather than running out the iteration budget
+typedef struct convergence_monitor_t {
+    Puzzle &puzzle;
+    const simplex_data_t *data;
+    unsigned unfilled; // non-concrete cells which have never collapsed
+    unsigned changed; // cells which collapsed to a new value this iteration
+    double maxDelta; // largest coordinate displacement this iteration
+    unsigned stagnantIters;
+    unsigned long long history[CONVERGENCE_HISTORY];
+    unsigned historyCursor;
+
+    convergence_monitor_t(Puzzle &puzzle, const simplex_data_t *data) : 
+        puzzle(puzzle), data(data), unfilled(0), changed(0), maxDelta(0), stagnantIters(0), historyCursor(0)
+    {
+        for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++) unfilled += !puzzle.isConcrete(cell);
+        for (unsigned long long *entry = history; entry < history + CONVERGENCE_HISTORY; entry++) *entry = 0;
+    }
+
+    // returns Solved if the puzzle needs no iterations at all
+    GraphTermination start() {
+        return unfilled == 0 && puzzle.isSolved() ? GraphTermination::Solved : GraphTermination::Running;
+    }
+
+    void startIteration() {
+        changed = 0;
+        maxDelta = 0;
+    }
+
+    void observe(unsigned char previousValue, unsigned char value, double delta) {
+        if (delta > maxDelta) maxDelta = delta;
+        if (value == previousValue) return;
+        changed++;
+        unfilled -= (previousValue == 0);
+    }
+
+    GraphTermination endIteration() {
+        // the grid only needs verifying once every cell holds a value, and something changed
+        if (changed && unfilled == 0 && puzzle.isSolved()) return GraphTermination::Solved;
+        if (changed == 0 && maxDelta < CONVERGENCE_EPSILON) return GraphTermination::Converged;
+        // iterations still moving the coordinates may yet collapse a cell
+        stagnantIters = changed || maxDelta >= CONVERGENCE_STAGNATION_DELTA ? 0 : stagnantIters + 1;
+        if (stagnantIters >= CONVERGENCE_STAGNATION_WINDOW) return GraphTermination::Stagnated;
+
+        // fingerprint the quantized coordinates to detect short cycles
+        unsigned long long fingerprint = 1469598103934665603ULL;
+        for (const simplex_data_t *cursor = data, *cursorMax = data + puzzle.getSizeSquared(); cursor < cursorMax; cursor++)
+            for (const double *val = cursor->position; val < cursor->positionEnd; val++)
+                fingerprint = (fingerprint ^ static_cast<unsigned long long>(*val * CONVERGENCE_QUANTUM)) * 1099511628211ULL;
+        for (unsigned long long *entry = history; entry < history + CONVERGENCE_HISTORY; entry++)
+            if (*entry == fingerprint) return GraphTermination::Oscillating;
+        history[historyCursor] = fingerprint;
+        historyCursor = (historyCursor + 1) % CONVERGENCE_HISTORY;
+
+        return GraphTermination::Running;
+    }
+} convergence_monitor_t;
+
 void MultiplicativeGraphSolver::solve(Puzzle &puzzle) {
     DEBUG_FUNC_HEADER("CollapsingGraphSolverV5::solve(Puzzle &puzzle)")
+    TRACE_BEGIN(TRACE_SOLVE, 0, 0)
 
     const unsigned numNeighborhoods = 3;
 
@@ -181,15 +277,17 @@ void MultiplicativeGraphSolver::solve(Puzzle &puzzle) {
 
     DEBUG_OUTPUT("Beginning graph collapse procedure")
     unsigned iteration = 0;
-    while(!puzzle.isSolved() && iteration++ < this->maxIters) {
+    convergence_monitor_t monitor(puzzle, data);
+    solve_budget_t budget(options);
+    this->termination = monitor.start();
+    while(this->termination == GraphTermination::Running && iteration++ < this->maxIters) {
         simplex_data_t *dataCursor = data, *updateCursor = update;
+        monitor.startIteration();
 
         // compute update vectors
         DEBUG_OUTPUT("Iteration %d: Computing update vectors", iteration)
-        DEBUG_STATEMENT(std::string nType = "row")
         DEBUG_INDENT()
         for (unsigned ***neighborhoodListCursor = neighborhoodList; neighborhoodListCursor < neighborhoodListMax; neighborhoodListCursor++) {
-            DEBUG_STATEMENT(unsigned n = 0)
             for (unsigned **neighborhoodCursor = *neighborhoodListCursor, **neighborhoodCursorMax = neighborhoodCursor + puzzle.getSize();
                 neighborhoodCursor < neighborhoodCursorMax; neighborhoodCursor++
             ) {
@@ -198,21 +296,14 @@ void MultiplicativeGraphSolver::solve(Puzzle &puzzle) {
                 for (unsigned *neighbor = *neighborhoodCursor; neighbor < neighborMax; neighbor++) {
                     updateBase -= data[*neighbor];
                 }
-                DEBUG_OUTPUT("Computed %s %d update: %s", nType.c_str(), n++, std::to_string(updateBase).c_str())
                 // updateBase *= SCALE_FACTOR;
-                DEBUG_STATEMENT(unsigned member = 0)
-                DEBUG_INDENT()
                 for (unsigned *neighbor = *neighborhoodCursor; neighbor < neighborMax; neighbor++) {
                     simplex_data_t temp(updateBase);
                     temp += data[*neighbor];
                     temp.constrainSimplexV5();
-                    DEBUG_OUTPUT("Member %d perspective: %s", member++, std::to_string(temp).c_str())
                     update[*neighbor] *= temp;
                 }
-                DEBUG_OUTDENT()
             }
-            DEBUG_STATEMENT(if (*nType.c_str() == 'r') nType = "column")
-            DEBUG_STATEMENT(else nType = "box")
         }
         DEBUG_OUTDENT()
 
@@ -225,41 +316,45 @@ void MultiplicativeGraphSolver::solve(Puzzle &puzzle) {
             // ignore concrete cells
             if (puzzle.isConcrete(cell)) continue;
 
-            DEBUG_OUTPUT("Updating Cell %d", cell)
-            DEBUG_INDENT()
-
             // add update vectors and reconstrain to simplex
-            *dataCursor += *updateCursor;
-            dataCursor->constrainSimplex();
+            unsigned char previousValue = dataCursor->value;
+            double delta = dataCursor->step(*updateCursor);
 
-            DEBUG_OUTPUT("Update vector: %s", std::to_string(*updateCursor).c_str())
-            DEBUG_OUTPUT("Resultant vector: %s", std::to_string(*dataCursor).c_str())
-            
             // check for node collapse
             if (dataCursor->collapse()) {
-                DEBUG_OUTPUT("Collapsing cell at row %d and column %d to %d", CELL_TO_COORDS(cell, puzzle.getSize()), dataCursor->value)
-                puzzle.setValue(cell, dataCursor->value);
+                STATS_INC(stats, collapses)
+                puzzle.setValueUnchecked(cell, dataCursor->value);
             }
-
-            DEBUG_OUTDENT()
+            monitor.observe(previousValue, dataCursor->value, delta);
 
             // reset update cursor 
             *updateCursor = ONES;
         }
         DEBUG_OUTDENT()
+
+        this->termination = monitor.endIteration();
+        TRACE_INSTANT(TRACE_GRAPH_ITERATION, 0, iteration)
+        if (this->termination == GraphTermination::Running && budget.spendAndCheck(1)) break;
     }
+    if (this->termination == GraphTermination::Running) this->termination = GraphTermination::IterationLimit;
+    this->iterations = iteration > this->maxIters ? this->maxIters : iteration;
+    STATS_ADD(stats, iterations, this->iterations)
+    DEBUG_OUTPUT("Graph collapse terminated after %d iterations: %s", iteration, graphTerminationName(this->termination))
+    status = graphSolveStatus(this->termination, budget);
     
     // free heap memory
     DEBUG_OUTPUT("Puzzle solved")
     delete[] data;
     delete[] update;
 
+    TRACE_END(TRACE_SOLVE, 0, puzzle.isSolved())
     DEBUG_OUTPUT("Heap memory freed")
     DEBUG_FUNC_END()
 }
 
 void SimpleAdditiveGraphSolver::solve(Puzzle &puzzle) {
     DEBUG_FUNC_HEADER("CollapsingGraphSolverV4::solve(Puzzle &puzzle)")
+    TRACE_BEGIN(TRACE_SOLVE, 0, 0)
 
     const unsigned numNeighborhoods = 3;
 
@@ -305,8 +400,12 @@ void SimpleAdditiveGraphSolver::solve(Puzzle &puzzle) {
 
     DEBUG_OUTPUT("Beginning graph collapse procedure")
     unsigned iteration = 0;
-    while(!puzzle.isSolved() && iteration++ < this->maxIters) {
+    convergence_monitor_t monitor(puzzle, data);
+    solve_budget_t budget(options);
+    this->termination = monitor.start();
+    while(this->termination == GraphTermination::Running && iteration++ < this->maxIters) {
         simplex_data_t *dataCursor = data, *updateCursor = update;
+        monitor.startIteration();
 
         // compute update vectors
         DEBUG_OUTPUT("Iteration %d: Computing update vectors", iteration)
@@ -330,31 +429,45 @@ void SimpleAdditiveGraphSolver::solve(Puzzle &puzzle) {
             if (puzzle.isConcrete(cell)) continue;
 
             // add update vectors and reconstrain to simplex
-            *dataCursor += *updateCursor;
-            dataCursor->constrainSimplex();
-            DEBUG_STATEMENT(simplex_data_t mem(*dataCursor))
+            unsigned char previousValue = dataCursor->value;
+            double delta = dataCursor->step(*updateCursor);
             
             // check for node collapse
             if (dataCursor->collapse()) {
-                DEBUG_OUTPUT("Collapsing cell at row %d and column %d to %d from %s", CELL_TO_COORDS(cell, puzzle.getSize()), dataCursor->value, std::to_string(mem).c_str())
-                puzzle.setValue(cell, dataCursor->value);
+                STATS_INC(stats, collapses)
+                puzzle.setValueUnchecked(cell, dataCursor->value);
             }
+            monitor.observe(previousValue, dataCursor->value, delta);
         }
         DEBUG_OUTDENT()
-        
+
+        this->termination = monitor.endIteration();
+        TRACE_INSTANT(TRACE_GRAPH_ITERATION, 0, iteration)
+        if (this->termination == GraphTermination::Running && budget.spendAndCheck(1)) break;
     }
+    if (this->termination == GraphTermination::Running) this->termination = GraphTermination::IterationLimit;
+    this->iterations = iteration > this->maxIters ? this->maxIters : iteration;
+    STATS_ADD(stats, iterations, this->iterations)
+    DEBUG_OUTPUT("Graph collapse terminated after %d iterations: %s", iteration, graphTerminationName(this->termination))
+    status = graphSolveStatus(this->termination, budget);
     
     // free heap memory
     DEBUG_OUTPUT("Puzzle solved")
     delete[] data;
     delete[] update;
 
+    TRACE_END(TRACE_SOLVE, 0, puzzle.isSolved())
     DEBUG_OUTPUT("Heap memory freed")
     DEBUG_FUNC_END()
 }
 
-void AdditiveGraphSolver::solve(Puzzle &puzzle) {
-    DEBUG_FUNC_HEADER("CollapsingGraphSolver::solve(Puzzle &puzzle)")
+// Runs at most maxIters iterations of the additive collapse procedure, leaving 
+// the final simplex coordinates of every cell in data (sizeSquared elements).
+// Every iteration is charged to budget, and the collapse stops once it runs out.
+static GraphTermination additiveCollapse(Puzzle &puzzle, simplex_data_t *data, unsigned maxIters, unsigned &iterations, 
+    solver_stats_t &stats, solve_budget_t &budget
+) {
+    DEBUG_FUNC_HEADER("additiveCollapse(Puzzle &puzzle, simplex_data_t*, %d)", maxIters)
 
     const unsigned numNeighborhoods = 3;
 
@@ -370,7 +483,6 @@ void AdditiveGraphSolver::solve(Puzzle &puzzle) {
     const double simplexInitVal = 1. / puzzle.getSize();
 
     // initialize simplex data 
-    simplex_data_t *data = new simplex_data_t[puzzle.getSizeSquared()];
     simplex_data_t *update = new simplex_data_t[puzzle.getSizeSquared()];
     simplex_data_t *dataCursorCeiling = data + puzzle.getSizeSquared();
     unsigned cell = 0;
@@ -402,19 +514,19 @@ void AdditiveGraphSolver::solve(Puzzle &puzzle) {
 
     DEBUG_OUTPUT("Beginning graph collapse procedure")
     unsigned iteration = 0;
-    while(!puzzle.isSolved() && iteration++ < this->maxIters) {
+    convergence_monitor_t monitor(puzzle, data);
+    GraphTermination termination = monitor.start();
+    while(termination == GraphTermination::Running && iteration++ < maxIters) {
         simplex_data_t *dataCursor = data, *updateCursor = update;
+        monitor.startIteration();
 
         // compute update vectors
         DEBUG_OUTPUT("Iteration %d: Computing update vectors", iteration)
-        DEBUG_STATEMENT(std::string nType = "row")
         DEBUG_INDENT()
         for (unsigned ***neighborhoodListCursor = neighborhoodList; neighborhoodListCursor < neighborhoodListMax; neighborhoodListCursor++) {
-            DEBUG_STATEMENT(unsigned n = 1;)
             for (unsigned **neighborhoodCursor = *neighborhoodListCursor, **neighborhoodCursorMax = neighborhoodCursor + puzzle.getSize();
                 neighborhoodCursor < neighborhoodCursorMax; neighborhoodCursor++
             ) {
-                DEBUG_OUTPUT("Computing %s %d update", nType.c_str(), n++)
                 simplex_data_t updateBase(UPDATE_INIT);
                 unsigned *neighborMax = *neighborhoodCursor + puzzle.getSize();
                 for (unsigned *neighbor = *neighborhoodCursor; neighbor < neighborMax; neighbor++) {
@@ -424,8 +536,6 @@ void AdditiveGraphSolver::solve(Puzzle &puzzle) {
                 for (unsigned *neighbor = *neighborhoodCursor; neighbor < neighborMax; neighbor++)
                     update[*neighbor] += updateBase;
             }
-            DEBUG_STATEMENT(if (*nType.c_str() == 'r') nType = "column")
-            DEBUG_STATEMENT(else nType = "box")
         }
         DEBUG_OUTDENT()
 
@@ -439,27 +549,100 @@ void AdditiveGraphSolver::solve(Puzzle &puzzle) {
             if (puzzle.isConcrete(cell)) continue;
 
             // add update vectors and reconstrain to simplex
-            *dataCursor += *updateCursor;
-            dataCursor->constrainSimplex();
-            DEBUG_STATEMENT(simplex_data_t mem(*dataCursor))
+            unsigned char previousValue = dataCursor->value;
+            double delta = dataCursor->step(*updateCursor);
             
             // check for node collapse
             if (dataCursor->collapse()) {
-                DEBUG_OUTPUT("Collapsing cell at row %d and column %d to %d from %s", CELL_TO_COORDS(cell, puzzle.getSize()), dataCursor->value, std::to_string(mem).c_str())
-                puzzle.setValue(cell, dataCursor->value);
+                STATS_INC(stats, collapses)
+                puzzle.setValueUnchecked(cell, dataCursor->value);
             }
+            monitor.observe(previousValue, dataCursor->value, delta);
 
             // reset update cursor to current location
             *updateCursor = *dataCursor;
         }
         DEBUG_OUTDENT()
+
+        termination = monitor.endIteration();
+        TRACE_INSTANT(TRACE_GRAPH_ITERATION, 0, iteration)
+        if (termination == GraphTermination::Running && budget.spendAndCheck(1)) break;
     }
+    if (termination == GraphTermination::Running) termination = GraphTermination::IterationLimit;
+    iterations = iteration > maxIters ? maxIters : iteration;
+    STATS_ADD(stats, iterations, iterations)
+    DEBUG_OUTPUT("Graph collapse terminated after %d iterations: %s", iteration, graphTerminationName(termination))
     
     // free heap memory
-    DEBUG_OUTPUT("Puzzle solved")
-    delete[] data;
     delete[] update;
 
     DEBUG_OUTPUT("Heap memory freed")
+    DEBUG_FUNC_RETURN(static_cast<int>(termination))
+    return termination;
+}
+
+void AdditiveGraphSolver::solve(Puzzle &puzzle) {
+    DEBUG_FUNC_HEADER("CollapsingGraphSolver::solve(Puzzle &puzzle)")
+    TRACE_BEGIN(TRACE_SOLVE, 0, 0)
+    simplex_data_t *data = new simplex_data_t[puzzle.getSizeSquared()];
+    solve_budget_t budget(options);
+    this->termination = additiveCollapse(puzzle, data, this->maxIters, this->iterations, this->stats, budget);
+    status = graphSolveStatus(this->termination, budget);
+    delete[] data;
+    TRACE_END(TRACE_SOLVE, 0, puzzle.isSolved())
     DEBUG_FUNC_END()
-}
\ No newline at end of file
+}
+
+// Candidate search which tries the values a cell's simplex coordinates favor first
+class SimplexOrderedSearch : public CandidateSearch {
+    private:
+        const simplex_data_t *data;
+    protected:
+        unsigned char nextValue(unsigned cell, unsigned remaining) override {
+            const double *position = data[cell].position;
+            unsigned char best = __builtin_ctz(remaining) + 1;
+            for (unsigned char value = best + 1; value <= data[cell].ndims; value++)
+                if ((remaining & CANDIDATE_BIT(value)) && position[value - 1] > position[best - 1]) best = value;
+            return best;
+        }
+    public:
+        SimplexOrderedSearch(CandidateGrid &grid, const simplex_data_t *data) : CandidateSearch(grid), data(data) {};
+};
+
+void HybridGraphSolver::solve(Puzzle &puzzle) {
+    DEBUG_FUNC_HEADER("HybridGraphSolver::solve(Puzzle &puzzle)")
+    TRACE_BEGIN(TRACE_SOLVE, 0, 0)
+
+    // fast path: bounded graph collapse
+    simplex_data_t *data = new simplex_data_t[puzzle.getSizeSquared()];
+    solve_budget_t budget(options);
+    this->termination = additiveCollapse(puzzle, data, this->maxIters, this->iterations, this->stats, budget);
+    if (this->termination == GraphTermination::Solved || budget.stopped()) {
+        DEBUG_OUTPUT("Graph collapse stopped: %s", graphTerminationName(this->termination))
+        status = graphSolveStatus(this->termination, budget);
+        delete[] data;
+        TRACE_END(TRACE_SOLVE, 0, status == SolveStatus::Solved)
+        DEBUG_FUNC_END()
+        return;
+    }
+
+    // exact search from the givens, treating the collapse decisions as the first guesses
+    DEBUG_OUTPUT("Graph collapse stalled... seeding exact search")
+    CandidateGrid grid(puzzle, true);
+    SimplexOrderedSearch search(grid, data);
+    search.limit(&budget);
+    unsigned char solution[puzzle.getSizeSquared()];
+    if (search.search(1, solution)) {
+        for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++)
+            if (!puzzle.isConcrete(cell)) puzzle.setValueUnchecked(cell, solution[cell]);
+        status = SolveStatus::Solved;
+    }
+    else status = budget.stopped() ? budget.status : SolveStatus::Unsolvable;
+    STATS_ADD(stats, nodes, search.nodes)
+    STATS_ADD(stats, backtracks, search.backtracks)
+    STATS_ADD(stats, eliminations, search.eliminations)
+
+    delete[] data;
+    TRACE_END(TRACE_SOLVE, 0, puzzle.isSolved())
+    DEBUG_FUNC_END()
+}
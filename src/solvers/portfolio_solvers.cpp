@@ -0,0 +1,109 @@
+#include "solvers.h"
+#include "puzzle.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+using namespace Solvers;
+
+PortfolioSolver::PortfolioSolver(const std::vector<Solver *> &engines, unsigned threads, bool learn) :
+    threads(threads), learn(learn), winner(-1)
+{
+    for (Solver *engine : engines) this->engines.emplace_back(engine);
+}
+
+unsigned PortfolioSolver::getWins(unsigned engine) const {
+    unsigned total = 0;
+    for (const auto &bucket : history) total += bucket.second[engine].wins;
+    return total;
+}
+
+// Orders the engines by their expected time to win on the puzzle's size and clue bucket,
+// keeping the given order among equals and when there is no history
+void PortfolioSolver::rank(const Puzzle &puzzle, unsigned &bucket, std::vector<unsigned> &order) const {
+    unsigned clues = 0;
+    for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++) clues += puzzle.isConcrete(cell);
+    bucket = (puzzle.getSize() << 16) | (clues / PORTFOLIO_CLUE_BUCKET);
+
+    order.resize(engines.size());
+    std::iota(order.begin(), order.end(), 0);
+    auto found = history.find(bucket);
+    if (!learn || found == history.end()) return;
+    std::vector<double> expected(engines.size());
+    for (unsigned engine = 0; engine < engines.size(); engine++) {
+        const engine_history_t &past = found->second[engine];
+        if (past.runs == 0) expected[engine] = 0;
+        else expected[engine] = past.wins ? static_cast<double>(past.elapsed) / past.wins : HUGE_VAL;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](unsigned a, unsigned b) { return expected[a] < expected[b]; });
+}
+
+void PortfolioSolver::solve(Puzzle &puzzle) {
+    DEBUG_FUNC_HEADER("PortfolioSolver::solve(Puzzle &)")
+    TRACE_BEGIN(TRACE_SOLVE, 0, 0)
+    unsigned numEngines = engines.size();
+    unsigned bucket;
+    std::vector<unsigned> order;
+    rank(puzzle, bucket, order);
+
+    // every engine solves its own copy, and the first conclusive one cancels the rest
+    CancellationToken race(options.cancellation);
+    solve_options_t engineOptions = options;
+    engineOptions.cancellation = &race;
+    std::vector<Puzzle> copies(numEngines, puzzle);
+    std::vector<solve_result_t> results(numEngines, {SolveStatus::Running, nullptr, solver_stats_t(), 0});
+    std::atomic<unsigned> cursor(0);
+    std::atomic<int> first(-1);
+    auto run = [&]() {
+        for (unsigned next = cursor++; next < numEngines && !race.isCancelled(); next = cursor++) {
+            unsigned engine = order[next];
+            results[engine] = engines[engine]->solve(copies[engine], engineOptions);
+            SolveStatus status = results[engine].status;
+            int none = -1;
+            if ((status == SolveStatus::Solved || status == SolveStatus::Unsolvable) && first.compare_exchange_strong(none, engine))
+                race.cancel();
+        }
+    };
+    unsigned numThreads = threads ? std::min(threads, numEngines) : numEngines;
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < numThreads; t++) workers.emplace_back(run);
+    run();
+    for (std::thread &worker : workers) worker.join();
+    for (const solve_result_t &result : results) stats += result.stats;
+
+    winner = first.load();
+    if (winner >= 0) {
+        DEBUG_OUTPUT("Engine %d concluded first: %s", winner, solveStatusName(results[winner].status))
+        status = results[winner].status;
+        if (status == SolveStatus::Solved) {
+            for (unsigned cell = 0; cell < puzzle.getSizeSquared(); cell++)
+                if (!puzzle.isConcrete(cell)) puzzle.setValueUnchecked(cell, copies[winner].getValue(cell));
+        }
+    }
+    else {
+        // no engine concluded: report the caller's limit if one stopped an engine, or kept them all from starting
+        status = options.cancellation && options.cancellation->isCancelled() ? SolveStatus::Cancelled : SolveStatus::Unsolved;
+        for (const solve_result_t &result : results)
+            if (result.status == SolveStatus::BudgetExhausted || result.status == SolveStatus::TimedOut ||
+                result.status == SolveStatus::Cancelled) status = result.status;
+    }
+
+    // engines which never started learn nothing
+    if (learn) {
+        std::vector<engine_history_t> &past = history[bucket];
+        past.resize(numEngines);
+        for (unsigned engine = 0; engine < numEngines; engine++) {
+            if (results[engine].status == SolveStatus::Running) continue;
+            past[engine].elapsed += results[engine].elapsed;
+            past[engine].runs++;
+        }
+        if (winner >= 0) past[winner].wins++;
+    }
+    TRACE_END(TRACE_SOLVE, 0, status == SolveStatus::Solved)
+    DEBUG_FUNC_END()
+}
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+#include "trace.h"
+
+const char * traceEventName(uint16_t event) {
+	switch (event) {
+		case TRACE_SOLVE: return "solve";
+		case TRACE_BACKTRACK: return "backtrack";
+		case TRACE_BRANCH: return "branch";
+		case TRACE_HEAT: return "heat";
+		case TRACE_EXCHANGE: return "exchange";
+		case TRACE_GRAPH_ITERATION: return "graph iteration";
+		default: return "unknown";
+	}
+}
+
+void TraceBuffer::copyTo(std::vector<trace_event_t> &out) const {
+	uint64_t end = head.load(std::memory_order_acquire);
+	uint64_t begin = end > TRACE_BUFFER_EVENTS ? end - TRACE_BUFFER_EVENTS : 0;
+	for (uint64_t position = begin; position < end; position++)
+		out.push_back(events[position & (TRACE_BUFFER_EVENTS - 1)]);
+}
+
+TraceBuffer *TraceLog::acquire(uint32_t &thread) {
+	thread = nextThread++;
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!idle.empty()) {
+		TraceBuffer *buffer = idle.back();
+		idle.pop_back();
+		return buffer;
+	}
+	buffers.emplace_back(new TraceBuffer());
+	return buffers.back().get();
+}
+
+void TraceLog::release(TraceBuffer *buffer) {
+	std::lock_guard<std::mutex> lock(mutex);
+	idle.push_back(buffer);
+}
+
+std::vector<trace_event_t> TraceLog::collect() {
+	DEBUG_FUNC_HEADER("TraceLog::collect()")
+	std::vector<trace_event_t> events;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (std::unique_ptr<TraceBuffer> &buffer : buffers) buffer->copyTo(events);
+	}
+	std::stable_sort(events.begin(), events.end(), [](const trace_event_t &a, const trace_event_t &b) {
+		return a.timestamp < b.timestamp;
+	});
+	DEBUG_FUNC_END()
+	return events;
+}
+
+void TraceLog::clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (std::unique_ptr<TraceBuffer> &buffer : buffers) buffer->clear();
+}
+
+bool TraceLog::write(const std::string &filepath) {
+	DEBUG_FUNC_HEADER("TraceLog::write(%s)", filepath.c_str())
+	std::ofstream file(filepath, std::ios::binary);
+	if (!file) {
+		DEBUG_FUNC_RETURN(false)
+		return false;
+	}
+	std::vector<trace_event_t> events = collect();
+
+	uint32_t header[3] = {TRACE_FILE_VERSION, sizeof(trace_event_t), TRACE_NUM_EVENTS};
+	file.write(TRACE_FILE_MAGIC, 8);
+	file.write(reinterpret_cast<const char *>(header), sizeof(header));
+	for (uint16_t event = 0; event < TRACE_NUM_EVENTS; event++) {
+		const char *name = traceEventName(event);
+		uint32_t length = strlen(name);
+		file.write(reinterpret_cast<const char *>(&length), sizeof(length));
+		file.write(name, length);
+	}
+	uint64_t count = events.size();
+	file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+	file.write(reinterpret_cast<const char *>(events.data()), count * sizeof(trace_event_t));
+
+	DEBUG_FUNC_RETURN(file.good())
+	return file.good();
+}
+
+bool TraceLog::read(const std::string &filepath, std::vector<std::string> &names, std::vector<trace_event_t> &events) {
+	DEBUG_FUNC_HEADER("TraceLog::read(%s, vector<string>&, vector<trace_event_t>&)", filepath.c_str())
+	std::ifstream file(filepath, std::ios::binary);
+	char magic[8];
+	uint32_t header[3];
+	if (!file.read(magic, 8) || memcmp(magic, TRACE_FILE_MAGIC, 8)
+		|| !file.read(reinterpret_cast<char *>(header), sizeof(header))
+		|| header[0] != TRACE_FILE_VERSION || header[1] != sizeof(trace_event_t)) {
+		DEBUG_FUNC_RETURN(false)
+		return false;
+	}
+
+	names.clear();
+	for (uint32_t event = 0; event < header[2]; event++) {
+		uint32_t length;
+		if (!file.read(reinterpret_cast<char *>(&length), sizeof(length)) || length > 1024) {
+			DEBUG_FUNC_RETURN(false)
+			return false;
+		}
+		std::string name(length, '\0');
+		file.read(&name[0], length);
+		names.push_back(name);
+	}
+
+	// the count must fit in the rest of the file
+	uint64_t count;
+	std::streampos start = file.tellg();
+	file.seekg(0, std::ios::end);
+	uint64_t remaining = file.tellg() - start;
+	file.seekg(start);
+	if (!file.read(reinterpret_cast<char *>(&count), sizeof(count)) || count > remaining / sizeof(trace_event_t)) {
+		DEBUG_FUNC_RETURN(false)
+		return false;
+	}
+	events.resize(count);
+	file.read(reinterpret_cast<char *>(events.data()), count * sizeof(trace_event_t));
+
+	DEBUG_FUNC_RETURN(file.good())
+	return file.good();
+}
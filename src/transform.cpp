@@ -0,0 +1,98 @@
+#include <utility>
+
+#include "transform.h"
+#include "puzzle.h"
+
+// #define DEBUG_ENABLED
+#include "debugging.h"
+
+sudoku_transform_t sudoku_transform_t::identity(unsigned char size) {
+	sudoku_transform_t transform;
+	transform.size = size;
+	transform.transpose = false;
+	transform.rows.resize(size);
+	transform.cols.resize(size);
+	transform.relabel.resize(size + 1);
+	for (unsigned char i = 0; i < size; i++) transform.rows[i] = transform.cols[i] = i;
+	for (unsigned char value = 0; value <= size; value++) transform.relabel[value] = value;
+	return transform;
+}
+
+// Shuffles the n elements of values in place (Fisher-Yates)
+static void shuffle(unsigned char *values, unsigned n, Random &random) {
+	for (unsigned i = n - 1; i > 0 && i < n; i--) std::swap(values[i], values[random.below(i + 1)]);
+}
+
+// Fills order with a permutation of the lines of a band structure: a random order
+// of the bands, and a random order of the lines within every band
+static void shuffleLines(std::vector<unsigned char> &order, unsigned char sizeSqrt, Random &random) {
+	unsigned char bands[sizeSqrt], lines[sizeSqrt];
+	for (unsigned char band = 0; band < sizeSqrt; band++) bands[band] = band;
+	shuffle(bands, sizeSqrt, random);
+	for (unsigned char band = 0; band < sizeSqrt; band++) {
+		for (unsigned char line = 0; line < sizeSqrt; line++) lines[line] = line;
+		shuffle(lines, sizeSqrt, random);
+		for (unsigned char line = 0; line < sizeSqrt; line++) order[band * sizeSqrt + line] = bands[band] * sizeSqrt + lines[line];
+	}
+}
+
+sudoku_transform_t sudoku_transform_t::random(unsigned char size, Random &random) {
+	DEBUG_OUTPUT("sudoku_transform_t::random(%d, Random&)", size)
+	sudoku_transform_t transform = identity(size);
+	unsigned char sizeSqrt = perfectSqrt(size);
+	transform.transpose = random.below(2);
+	shuffleLines(transform.rows, sizeSqrt, random);
+	shuffleLines(transform.cols, sizeSqrt, random);
+	shuffle(transform.relabel.data() + 1, size, random);
+	return transform;
+}
+
+sudoku_transform_t sudoku_transform_t::inverse() const {
+	// source'[rows[r]][cols[c]] = relabel^-1[target[r][c]], and transposing both sides
+	// swaps which permutation applies to the rows of the result
+	sudoku_transform_t inverse = identity(size);
+	inverse.transpose = transpose;
+	const std::vector<unsigned char> &inverseRows = transpose ? cols : rows, &inverseCols = transpose ? rows : cols;
+	for (unsigned char line = 0; line < size; line++) {
+		inverse.rows[inverseRows[line]] = line;
+		inverse.cols[inverseCols[line]] = line;
+	}
+	for (unsigned char value = 0; value <= size; value++) inverse.relabel[relabel[value]] = value;
+	return inverse;
+}
+
+void sudoku_transform_t::apply(const unsigned char *source, unsigned char *target) const {
+	for (unsigned row = 0; row < size; row++) {
+		unsigned char *targetRow = target + row * size;
+		if (transpose) {
+			for (unsigned col = 0; col < size; col++) targetRow[col] = relabel[source[cols[col] * size + rows[row]]];
+		} else {
+			const unsigned char *sourceRow = source + rows[row] * size;
+			for (unsigned col = 0; col < size; col++) targetRow[col] = relabel[sourceRow[cols[col]]];
+		}
+	}
+}
+
+bool sudoku_transform_t::isValid() const {
+	unsigned char sizeSqrt = perfectSqrt(size);
+	if (sizeSqrt == 0 || rows.size() != size || cols.size() != size || relabel.size() != size + 1U || relabel[0] != 0)
+		return false;
+
+	// every band (or stack) of the result must come whole from one band of the source
+	for (const std::vector<unsigned char> *order : {&rows, &cols}) {
+		bool used[size] = {};
+		for (unsigned char line = 0; line < size; line++) {
+			unsigned char source = (*order)[line];
+			if (source >= size || used[source]) return false;
+			used[source] = true;
+			if (source / sizeSqrt != (*order)[line - line % sizeSqrt] / sizeSqrt) return false;
+		}
+	}
+	bool used[size + 1] = {};
+	for (unsigned char value = 1; value <= size; value++) {
+		unsigned char label = relabel[value];
+		if (label == 0 || label > size || used[label]) return false;
+		used[label] = true;
+	}
+	return true;
+}
@@ -0,0 +1,34 @@
+#ifndef SUDOKU_TEST_PUZZLES_H
+#define SUDOKU_TEST_PUZZLES_H
+
+#include <puzzle.h>
+#include <gtest/gtest.h>
+#include <cstring>
+
+// Arto Inkala's "world's hardest sudoku" and its unique solution
+const char * const HARD_PUZZLE = "800000000003600000070090200050007000000045700000100030001000068008500010090000400";
+const char * const HARD_SOLUTION = "812753649943682175675491283154237896369845721287169534521974368438526917796318452";
+
+// Base of the suites which start from the hard puzzle, with its givens and solution as values
+class HardPuzzleTest : public ::testing::Test {
+	protected:
+		unsigned char values[81], solution[81];
+
+		// The hard puzzle with a 2 in its second cell. No given in the first row, column or
+		// box conflicts with it, but the solution has a 1 there, so there is no solution.
+		Puzzle contradictoryPuzzle() const {
+			unsigned char contradictory[81];
+			memcpy(contradictory, values, 81);
+			contradictory[1] = 2;
+			return Puzzle(9, contradictory);
+		}
+	public:
+		HardPuzzleTest() {
+			for (unsigned cell = 0; cell < 81; cell++) {
+				values[cell] = HARD_PUZZLE[cell] - '0';
+				solution[cell] = HARD_SOLUTION[cell] - '0';
+			}
+		}
+};
+
+#endif // SUDOKU_TEST_PUZZLES_H
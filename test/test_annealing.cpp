@@ -0,0 +1,76 @@
+#include <puzzle.h>
+#include <solvers.h>
+#include <annealing.h>
+#include <random.h>
+#include <gtest/gtest.h>
+#include "puzzles.h"
+
+namespace {
+
+// Repeated values over every column and box, counted from scratch
+unsigned recountCost(const anneal_state_t &state) {
+	unsigned cost = 0;
+	for (unsigned unit = 0; unit < state.size; unit++) {
+		unsigned colCounts[17] = {}, boxCounts[17] = {};
+		unsigned boxRow = (unit / state.sizeSqrt) * state.sizeSqrt, boxCol = (unit % state.sizeSqrt) * state.sizeSqrt;
+		for (unsigned i = 0; i < state.size; i++) {
+			cost += colCounts[state.values[i * state.size + unit]]++ > 0;
+			unsigned cell = (boxRow + i / state.sizeSqrt) * state.size + boxCol + i % state.sizeSqrt;
+			cost += boxCounts[state.values[cell]]++ > 0;
+		}
+	}
+	return cost;
+}
+
+class AnnealingTest : public HardPuzzleTest {
+	protected:
+		unsigned char easy[81];
+	public:
+		AnnealingTest() {
+			// the easy puzzle leaves one cell in three empty
+			for (unsigned cell = 0; cell < 81; cell++) easy[cell] = cell % 3 ? solution[cell] : 0;
+		}
+};
+
+TEST_F(AnnealingTest, TestSwapDeltaMatchesRecount) {
+	Puzzle puzzle(9, values);
+	anneal_state_t state(puzzle);
+	ASSERT_EQ(state.cost, recountCost(state));
+
+	Random random(11);
+	for (unsigned trial = 0; trial < 2000; trial++) {
+		unsigned char row = state.swapRows[random.below(state.numSwapRows)];
+		unsigned char col1 = state.freeCols[row * 9 + random.below(state.numFree[row])];
+		unsigned char col2 = state.freeCols[row * 9 + random.below(state.numFree[row])];
+		if (col1 == col2) continue;
+		int delta = state.swapDelta(row, col1, col2);
+		unsigned before = state.cost;
+		state.swap(row, col1, col2, delta);
+		ASSERT_EQ(state.cost, recountCost(state)) << "swap " << trial;
+		ASSERT_EQ(static_cast<int>(state.cost) - static_cast<int>(before), delta);
+	}
+}
+
+TEST_F(AnnealingTest, TestParallelTemperingSolvesEasyPuzzle) {
+	Puzzle puzzle(9, easy);
+	Solvers::ParallelTemperingSolver tempering(2, 1000, 2, 0.8, 1, 1);
+	EXPECT_EQ(tempering.solve(puzzle, solve_options_t()).status, SolveStatus::Solved);
+	EXPECT_TRUE(puzzle.isSolved());
+}
+
+TEST_F(AnnealingTest, TestSchedulesSolveEasyPuzzle) {
+	std::unique_ptr<Solvers::Solver> solvers[] = {
+		std::unique_ptr<Solvers::Solver>(new Solvers::GeometricAnnealingSolver(20, 50, 0, 0.9, 1)),
+		std::unique_ptr<Solvers::Solver>(new Solvers::LinearAnnealingSolver(20, 50, 0, 0.05, 1)),
+		std::unique_ptr<Solvers::Solver>(new Solvers::LogarithmicAnnealingSolver(20, 50, 0, 1)),
+		std::unique_ptr<Solvers::Solver>(new Solvers::LundyMeesAnnealingSolver(20, 50, 0, 0.1, 1)),
+		std::unique_ptr<Solvers::Solver>(new Solvers::AdaptiveAnnealingSolver(20, 50, 0, 0.5, 0.9, 1))
+	};
+	for (unsigned i = 0; i < sizeof(solvers) / sizeof(*solvers); i++) {
+		Puzzle puzzle(9, easy);
+		EXPECT_EQ(solvers[i]->solve(puzzle, solve_options_t()).status, SolveStatus::Solved) << "schedule " << i;
+		EXPECT_TRUE(puzzle.isSolved()) << "schedule " << i;
+	}
+}
+
+}
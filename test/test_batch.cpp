@@ -0,0 +1,90 @@
+#include <puzzle.h>
+#include <solvers.h>
+#include <transform.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include "puzzles.h"
+
+namespace {
+
+class BatchTest : public HardPuzzleTest {
+	protected:
+		Solvers::BatchSolver solver;
+};
+
+TEST_F(BatchTest, TestBatchSolvesEveryLane) {
+	// more than two batches of transformed puzzles, every third one left to propagation alone
+	Random random(7);
+	std::vector<Puzzle> puzzles;
+	for (unsigned i = 0; i < 2 * BATCH_LANES + 3; i++) {
+		unsigned char given[81], transformed[81];
+		for (unsigned cell = 0; cell < 81; cell++) given[cell] = i % 3 || cell % 4 ? values[cell] : solution[cell];
+		sudoku_transform_t::random(9, random).apply(given, transformed);
+		puzzles.emplace_back(9, transformed);
+	}
+	std::vector<SolveStatus> statuses(puzzles.size());
+	solver.solveBatch(puzzles.data(), puzzles.size(), statuses.data());
+	for (unsigned i = 0; i < puzzles.size(); i++) {
+		EXPECT_EQ(statuses[i], SolveStatus::Solved) << "puzzle " << i;
+		EXPECT_TRUE(puzzles[i].isSolved()) << "puzzle " << i;
+	}
+	EXPECT_EQ(solver.getStatus(), SolveStatus::Solved);
+}
+
+TEST_F(BatchTest, TestContradictionsStayInTheirLanes) {
+	std::vector<Puzzle> puzzles(3, Puzzle(9, values));
+	puzzles.push_back(contradictoryPuzzle());
+	// a given repeated in the first row
+	values[1] = 8;
+	puzzles.emplace_back(9, values);
+	std::vector<SolveStatus> statuses(puzzles.size());
+	solver.solveBatch(puzzles.data(), puzzles.size(), statuses.data());
+	for (unsigned i = 0; i < 3; i++) {
+		EXPECT_EQ(statuses[i], SolveStatus::Solved);
+		EXPECT_TRUE(puzzles[i].isSolved());
+	}
+	EXPECT_EQ(statuses[3], SolveStatus::Unsolvable);
+	EXPECT_EQ(statuses[4], SolveStatus::Unsolvable);
+	for (unsigned cell = 0; cell < 81; cell++)
+		if (!puzzles[3].isConcrete(cell)) { EXPECT_EQ(puzzles[3].getValue(cell), 0); }
+}
+
+TEST_F(BatchTest, TestSizesAreBatchedApart) {
+	unsigned char small[16] = {1, 0, 0, 4, 0, 4, 0, 0, 0, 0, 4, 0, 4, 0, 0, 1};
+	std::vector<Puzzle> puzzles {Puzzle(9, values), Puzzle(4, small), Puzzle(4, small), Puzzle(9, values)};
+	std::vector<SolveStatus> statuses(puzzles.size());
+	solver.solveBatch(puzzles.data(), puzzles.size(), statuses.data());
+	for (unsigned i = 0; i < puzzles.size(); i++) {
+		EXPECT_EQ(statuses[i], SolveStatus::Solved);
+		EXPECT_TRUE(puzzles[i].isSolved());
+	}
+}
+
+TEST_F(BatchTest, TestLargeLanesAreSearched) {
+	// too few givens for propagation alone, so the lanes are searched over their 256 cells
+	unsigned char large[256];
+	for (unsigned row = 0; row < 16; row++)
+		for (unsigned col = 0; col < 16; col++) large[row * 16 + col] = (4 * (row % 4) + row / 4 + col) % 16 + 1;
+	Random random(3);
+	for (unsigned i = 0; i < 150; i++) large[random.below(256)] = 0;
+	std::vector<Puzzle> puzzles(2, Puzzle(16, large));
+	std::vector<SolveStatus> statuses(puzzles.size());
+	solver.solveBatch(puzzles.data(), puzzles.size(), statuses.data());
+	for (unsigned i = 0; i < puzzles.size(); i++) {
+		EXPECT_EQ(statuses[i], SolveStatus::Solved) << "puzzle " << i;
+		EXPECT_TRUE(puzzles[i].isSolved()) << "puzzle " << i;
+	}
+}
+
+TEST_F(BatchTest, TestSingleSolveHonoursLimits) {
+	Puzzle puzzle(9, values);
+	solve_options_t options;
+	options.budget = 1;
+	EXPECT_EQ(solver.solve(puzzle, options).status, SolveStatus::BudgetExhausted);
+	puzzle.reset();
+	Solvers::solve_result_t result = solver.solve(puzzle, solve_options_t());
+	EXPECT_TRUE(result.isSolved());
+	for (unsigned cell = 0; cell < 81; cell++) EXPECT_EQ(puzzle.getValue(cell), solution[cell]);
+}
+
+}
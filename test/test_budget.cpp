@@ -0,0 +1,83 @@
+#include <puzzle.h>
+#include <solvers.h>
+#include <budget.h>
+#include <random.h>
+#include <gtest/gtest.h>
+#include "puzzles.h"
+
+namespace {
+
+class BudgetTest : public HardPuzzleTest {};
+
+TEST_F(BudgetTest, TestUnboundedSolveSetsStatus) {
+	Puzzle puzzle(9, values);
+	Solvers::HybridGraphSolver solver;
+	solver.solve(puzzle);
+	EXPECT_EQ(solver.getStatus(), SolveStatus::Solved);
+	EXPECT_TRUE(puzzle.isSolved());
+}
+
+TEST_F(BudgetTest, TestSolvedOnlyOnceEveryCellIsPlaced) {
+	// 256 cells, past the range of an unsigned char
+	unsigned char large[256];
+	for (unsigned row = 0; row < 16; row++)
+		for (unsigned col = 0; col < 16; col++) large[row * 16 + col] = (4 * (row % 4) + row / 4 + col) % 16 + 1;
+	Random random(3);
+	for (unsigned i = 0; i < 30; i++) large[random.below(256)] = 0;
+	Puzzle puzzle(16, large);
+	Solvers::DepthFirstSolver depthFirst;
+	EXPECT_EQ(depthFirst.solve(puzzle, solve_options_t()).status, SolveStatus::Solved);
+	EXPECT_TRUE(puzzle.isSolved());
+}
+
+TEST_F(BudgetTest, TestExhaustedSearchIsUnsolvable) {
+	Puzzle puzzle = contradictoryPuzzle();
+	Solvers::DepthFirstSolver depthFirst;
+	EXPECT_EQ(depthFirst.solve(puzzle, solve_options_t()).status, SolveStatus::Unsolvable);
+	Solvers::HybridGraphSolver hybrid;
+	puzzle.reset();
+	EXPECT_EQ(hybrid.solve(puzzle, solve_options_t()).status, SolveStatus::Unsolvable);
+}
+
+TEST_F(BudgetTest, TestBudgetStopsSearch) {
+	Puzzle puzzle(9, values);
+	solve_options_t options;
+	options.budget = 100;
+	Solvers::DepthFirstSolver depthFirst;
+	EXPECT_EQ(depthFirst.solve(puzzle, options).status, SolveStatus::BudgetExhausted);
+	EXPECT_FALSE(puzzle.isSolved());
+
+	// the budget only applies to the bounded call
+	puzzle.reset();
+	depthFirst.solve(puzzle);
+	EXPECT_EQ(depthFirst.getStatus(), SolveStatus::Solved);
+
+	puzzle.reset();
+	Solvers::GeometricAnnealingSolver annealing(1000, 1000, 0, 0.9);
+	EXPECT_EQ(annealing.solve(puzzle, options).status, SolveStatus::BudgetExhausted);
+}
+
+TEST_F(BudgetTest, TestDeadlineAndCancellation) {
+	Puzzle puzzle(9, values);
+	solve_options_t expired;
+	expired.deadline = std::chrono::steady_clock::now();
+	Solvers::HybridGraphSolver hybrid;
+	EXPECT_EQ(hybrid.solve(puzzle, expired).status, SolveStatus::TimedOut);
+
+	CancellationToken token;
+	token.cancel();
+	solve_options_t cancelled;
+	cancelled.cancellation = &token;
+	puzzle.reset();
+	Solvers::ParallelTemperingSolver tempering(2, 1000, 0, 0.9);
+	EXPECT_EQ(tempering.solve(puzzle, cancelled).status, SolveStatus::Cancelled);
+
+	// a generous limit does not change the outcome
+	token.reset();
+	cancelled.timeout(std::chrono::seconds(60));
+	puzzle.reset();
+	EXPECT_EQ(hybrid.solve(puzzle, cancelled).status, SolveStatus::Solved);
+	EXPECT_TRUE(puzzle.isSolved());
+}
+
+}
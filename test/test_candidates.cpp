@@ -0,0 +1,99 @@
+#include <puzzle.h>
+#include <candidates.h>
+#include <solvers.h>
+#include <gtest/gtest.h>
+#include "puzzles.h"
+
+namespace {
+
+class CandidateTest : public HardPuzzleTest {
+	protected:
+		Puzzle puzzle;
+	public:
+		CandidateTest() {
+			Puzzle temp(9, values, solution);
+			puzzle.swap(temp);
+		}
+};
+
+TEST_F(CandidateTest, TestCandidateMasks) {
+	CandidateGrid grid(puzzle);
+	EXPECT_TRUE(grid.isConsistent());
+	EXPECT_EQ(grid.getNumEmpty(), 81U - 21U);
+
+	// row 0 holds 8, column 1 holds 7, 5 and 9, box 0 holds 8, 3 and 7
+	unsigned expected = 0x1FF & ~(CANDIDATE_BIT(8) | CANDIDATE_BIT(7) | CANDIDATE_BIT(5) | CANDIDATE_BIT(9) | CANDIDATE_BIT(3));
+	EXPECT_EQ(grid.candidates(1), expected);
+
+	grid.place(1, 1);
+	EXPECT_FALSE(grid.candidates(2) & CANDIDATE_BIT(1));
+	EXPECT_FALSE(grid.candidates(10) & CANDIDATE_BIT(1));
+	grid.remove(1);
+	EXPECT_EQ(grid.candidates(1), expected);
+}
+
+TEST_F(CandidateTest, TestInconsistentGivens) {
+	values[1] = 8; // duplicates the 8 in cell 0
+	CandidateGrid grid(Puzzle(9, values));
+	EXPECT_FALSE(grid.isConsistent());
+	EXPECT_EQ(CandidateSearch(grid).search(1), 0U);
+}
+
+TEST_F(CandidateTest, TestSearchFindsSolution) {
+	CandidateGrid grid(puzzle);
+	unsigned char found[81];
+	EXPECT_EQ(CandidateSearch(grid).search(2, found), 1U);
+	for (unsigned cell = 0; cell < 81; cell++) EXPECT_EQ(found[cell], solution[cell]);
+
+	// search leaves the grid untouched
+	for (unsigned cell = 0; cell < 81; cell++) EXPECT_EQ(grid.getValue(cell), values[cell]);
+}
+
+TEST_F(CandidateTest, TestSearchStopsAtLimit) {
+	CandidateGrid grid(Puzzle(9));
+	EXPECT_EQ(CandidateSearch(grid).search(5), 5U);
+	EXPECT_EQ(grid.getNumEmpty(), 81U);
+}
+
+TEST_F(CandidateTest, TestCountSolutions) {
+	EXPECT_EQ(countSolutions(puzzle, 2), 1U);
+
+	// removing a clue from the hardest puzzle leaves more than one solution
+	values[0] = 0;
+	EXPECT_EQ(countSolutions(Puzzle(9, values), 2), 2U);
+	EXPECT_EQ(countSolutions(Puzzle(9), 7), 7U);
+
+	values[0] = 8;
+	values[1] = 8;
+	EXPECT_EQ(countSolutions(Puzzle(9, values), 2), 0U);
+}
+
+TEST_F(CandidateTest, TestCountSolutionsRestoresGrid) {
+	CandidateGrid grid(puzzle);
+	EXPECT_EQ(grid.countSolutions(2), 1U);
+	EXPECT_EQ(grid.getNumEmpty(), 81U - 21U);
+	for (unsigned cell = 0; cell < 81; cell++) EXPECT_EQ(grid.getValue(cell), values[cell]);
+}
+
+TEST_F(CandidateTest, TestHybridGraphSolver) {
+	Solvers::HybridGraphSolver solver(5);
+	solver.solve(puzzle);
+	EXPECT_TRUE(puzzle.isSolved());
+}
+
+#ifdef SUDOKU_STATS_ENABLED
+TEST_F(CandidateTest, TestSolverStats) {
+	Solvers::HybridGraphSolver solver(5);
+	solver.solve(puzzle);
+	const solver_stats_t &stats = solver.getStats();
+	EXPECT_GT(stats.nodes, 0U);
+	EXPECT_GT(stats.eliminations, 0U);
+	EXPECT_GT(stats.iterations, 0U);
+	EXPECT_EQ(stats.movesProposed, 0U);
+
+	solver.resetStats();
+	EXPECT_EQ(solver.getStats().nodes, 0U);
+}
+#endif
+
+} // namespace
@@ -0,0 +1,93 @@
+#include <puzzle.h>
+#include <solvers.h>
+#include <canonical.h>
+#include <cache.h>
+#include <gtest/gtest.h>
+#include "puzzles.h"
+
+namespace {
+
+class CanonicalTest : public HardPuzzleTest {
+	protected:
+		unsigned char target[81];
+		Random random;
+};
+
+TEST_F(CanonicalTest, TestInverseTransform) {
+	for (unsigned trial = 0; trial < 20; trial++) {
+		sudoku_transform_t transform = sudoku_transform_t::random(9, random);
+		unsigned char restored[81];
+		transform.apply(solution, target);
+		transform.inverse().apply(target, restored);
+		for (unsigned cell = 0; cell < 81; cell++) ASSERT_EQ(restored[cell], solution[cell]);
+	}
+}
+
+TEST_F(CanonicalTest, TestTransformMapsToForm) {
+	canonical_form_t form = canonicalize(9, values);
+	ASSERT_TRUE(form.transform.isValid());
+	form.transform.apply(values, target);
+	for (unsigned cell = 0; cell < 81; cell++) EXPECT_EQ(target[cell], form.values[cell]);
+	EXPECT_EQ(form.hash, canonicalHash(9, form.values.data()));
+}
+
+TEST_F(CanonicalTest, TestIsomorphicPuzzlesShareForm) {
+	canonical_form_t form = canonicalize(9, values);
+	for (unsigned trial = 0; trial < 20; trial++) {
+		sudoku_transform_t::random(9, random).apply(values, target);
+		EXPECT_EQ(canonicalize(9, target), form);
+	}
+	// a different puzzle has a different form
+	values[0] = 0;
+	EXPECT_NE(canonicalize(9, values).hash, form.hash);
+}
+
+TEST_F(CanonicalTest, TestIsomorphicSolutionsShareForm) {
+	// every row of a filled grid ties in every column order, the hardest case for the node budget
+	canonical_form_t form = canonicalize(9, solution);
+	for (unsigned trial = 0; trial < 20; trial++) {
+		sudoku_transform_t::random(9, random).apply(solution, target);
+		EXPECT_EQ(canonicalize(9, target), form) << "trial " << trial;
+	}
+}
+
+TEST_F(CanonicalTest, TestCacheEvictsLeastRecentlyUsed) {
+	SolutionCache cache(2, 1);
+	canonical_form_t forms[3];
+	for (unsigned char i = 0; i < 3; i++) {
+		values[80] = i;
+		forms[i] = canonicalize(9, values);
+	}
+	cache.insert(forms[0], solution);
+	cache.insert(forms[1], solution);
+	EXPECT_TRUE(cache.lookup(forms[0], target)); // now the most recently used
+	cache.insert(forms[2], solution);
+	EXPECT_TRUE(cache.lookup(forms[0], target));
+	EXPECT_FALSE(cache.lookup(forms[1], target));
+	EXPECT_TRUE(cache.lookup(forms[2], target));
+	EXPECT_EQ(cache.size(), 2U);
+	EXPECT_EQ(cache.getHits(), 3U);
+	EXPECT_EQ(cache.getMisses(), 1U);
+}
+
+TEST_F(CanonicalTest, TestCachingSolverAnswersIsomorphicPuzzles) {
+	Solvers::CachingSolver solver(new Solvers::HybridGraphSolver());
+	Puzzle puzzle(9, values);
+	solver.solve(puzzle);
+	ASSERT_TRUE(puzzle.isSolved());
+	EXPECT_EQ(solver.getCache().getMisses(), 1U);
+
+	for (unsigned trial = 0; trial < 5; trial++) {
+		sudoku_transform_t transform = sudoku_transform_t::random(9, random);
+		transform.apply(values, target);
+		Puzzle isomorphic(9, target);
+		solver.solve(isomorphic);
+		ASSERT_TRUE(isomorphic.isSolved());
+		unsigned char expected[81];
+		transform.apply(solution, expected);
+		for (unsigned cell = 0; cell < 81; cell++) EXPECT_EQ(isomorphic.getValue(cell), expected[cell]);
+	}
+	EXPECT_EQ(solver.getCache().getHits(), 5U);
+}
+
+} // namespace
@@ -0,0 +1,99 @@
+#include <puzzle.h>
+#include <transform.h>
+#include <random.h>
+#include <dedupe.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "puzzles.h"
+
+namespace {
+
+#define NUM_BASES 8
+#define NUM_VARIANTS 3
+
+class DedupeTest : public HardPuzzleTest {
+	protected:
+		// every puzzle is a variant of a base: the base itself or one of its transforms
+		std::vector<Puzzle> puzzles;
+		std::vector<uint64_t> exact, isomorphic; // indices of the expected duplicates in order
+	public:
+		DedupeTest() {
+			// bases keep different numbers of givens, so none are isomorphic
+			unsigned char variants[NUM_BASES][NUM_VARIANTS][81];
+			Random random(13);
+			for (unsigned base = 0; base < NUM_BASES; base++) {
+				unsigned removed = 0;
+				for (unsigned cell = 0; cell < 81; cell++) {
+					variants[base][0][cell] = values[cell];
+					if (variants[base][0][cell] && removed < base) {
+						variants[base][0][cell] = 0;
+						removed++;
+					}
+				}
+				for (unsigned variant = 1; variant < NUM_VARIANTS; variant++)
+					sudoku_transform_t::random(9, random).apply(variants[base][0], variants[base][variant]);
+			}
+
+			bool seenExact[NUM_BASES][NUM_VARIANTS] = {}, seenBase[NUM_BASES] = {};
+			for (uint64_t index = 0; index < 60; index++) {
+				unsigned base = random.below(NUM_BASES), variant = random.below(NUM_VARIANTS);
+				puzzles.emplace_back(9, variants[base][variant]);
+				if (seenExact[base][variant]) exact.push_back(index);
+				if (seenBase[base]) isomorphic.push_back(index);
+				seenExact[base][variant] = seenBase[base] = true;
+			}
+		}
+
+		// Duplicate indices in order, as found by a finder in memory or with a tiny memory on disk
+		std::vector<uint64_t> findDuplicates(DuplicateKind kind, bool external) {
+			DuplicateFinder finder(kind, 1, external ? 64 : DEDUPE_DEFAULT_MEMORY, ::testing::TempDir(), external);
+			EXPECT_EQ(finder.isExternal(), external);
+			std::vector<uint64_t> found;
+			for (uint64_t index = 0; index < puzzles.size(); index++)
+				if (finder.add(puzzles[index], index)) found.push_back(index);
+			finder.finish();
+			for (uint64_t index; finder.nextDuplicate(index);) found.push_back(index);
+			EXPECT_TRUE(finder.isGood());
+			EXPECT_EQ(finder.getDuplicates(), found.size());
+			return found;
+		}
+};
+
+TEST_F(DedupeTest, TestKeySetGrowsPastHalfFull) {
+	// from 16 slots, with key zero and the key an empty slot would otherwise clash with
+	KeySet keys;
+	Random random(17);
+	std::vector<uint64_t> inserted {0, 1};
+	for (unsigned i = 0; i < 1000; i++) inserted.push_back(random.next());
+	for (uint64_t key : inserted) EXPECT_TRUE(keys.insert(key)) << "key " << key;
+	for (uint64_t key : inserted) EXPECT_FALSE(keys.insert(key)) << "key " << key;
+	EXPECT_EQ(keys.size(), inserted.size());
+}
+
+TEST_F(DedupeTest, TestExternalSorterMergesRuns) {
+	// ten keys per run, with repeats
+	ExternalSorter<uint64_t> sorter(::testing::TempDir(), 10 * sizeof(uint64_t));
+	Random random(19);
+	std::vector<uint64_t> items;
+	for (unsigned i = 0; i < 1000; i++) {
+		items.push_back(random.below(300));
+		sorter.push(items.back());
+	}
+	sorter.finish();
+	EXPECT_GT(sorter.getRuns(), 1U);
+	std::sort(items.begin(), items.end());
+	std::vector<uint64_t> merged;
+	for (uint64_t item; sorter.next(item);) merged.push_back(item);
+	EXPECT_TRUE(sorter.isGood());
+	EXPECT_EQ(merged, items);
+}
+
+TEST_F(DedupeTest, TestModesFindTheSameDuplicates) {
+	EXPECT_EQ(findDuplicates(DuplicateKind::Exact, false), exact);
+	EXPECT_EQ(findDuplicates(DuplicateKind::Exact, true), exact);
+	EXPECT_EQ(findDuplicates(DuplicateKind::Isomorphic, false), isomorphic);
+	EXPECT_EQ(findDuplicates(DuplicateKind::Isomorphic, true), isomorphic);
+}
+
+}
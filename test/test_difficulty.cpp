@@ -0,0 +1,45 @@
+#include <puzzle.h>
+#include <difficulty.h>
+#include <gtest/gtest.h>
+#include "puzzles.h"
+
+namespace {
+
+class DifficultyTest : public HardPuzzleTest {};
+
+TEST_F(DifficultyTest, TestNamesRoundTrip) {
+	for (Difficulty difficulty : {Difficulty::Easy, Difficulty::Medium, Difficulty::Hard, Difficulty::Expert})
+		EXPECT_EQ(parseDifficulty(difficultyName(difficulty)), difficulty);
+	EXPECT_EQ(parseDifficulty("impossible"), Difficulty::Invalid);
+}
+
+TEST_F(DifficultyTest, TestNakedSinglesAreEasy) {
+	// one hole per row leaves a single candidate in every empty cell
+	for (unsigned row = 0; row < 9; row++) solution[row * 9 + row] = 0;
+	difficulty_t rating = rateDifficulty(Puzzle(9, solution));
+	EXPECT_EQ(rating.level, Difficulty::Easy);
+	EXPECT_EQ(rating.nakedSingles, 9U);
+	EXPECT_EQ(rating.hiddenSingles, 0U);
+	EXPECT_EQ(rating.search.nodes, 0U);
+}
+
+TEST_F(DifficultyTest, TestHardestPuzzleNeedsSearch) {
+	difficulty_t rating = rateDifficulty(Puzzle(9, values));
+	EXPECT_GE(rating.level, Difficulty::Hard);
+	EXPECT_NE(rating.level, Difficulty::Invalid);
+	EXPECT_GT(rating.search.nodes, 0U);
+
+	// an easier puzzle always scores lower
+	for (unsigned row = 0; row < 9; row++) solution[row * 9 + row] = 0;
+	EXPECT_LT(rateDifficulty(Puzzle(9, solution)).score, rating.score);
+}
+
+TEST_F(DifficultyTest, TestAmbiguousPuzzleIsInvalid) {
+	values[0] = 0;
+	EXPECT_EQ(rateDifficulty(Puzzle(9, values)).level, Difficulty::Invalid);
+	values[0] = 8;
+	values[1] = 8;
+	EXPECT_EQ(rateDifficulty(Puzzle(9, values)).level, Difficulty::Invalid);
+}
+
+} // namespace
@@ -0,0 +1,131 @@
+#include <puzzle.h>
+#include <candidates.h>
+#include <random.h>
+#include <generate.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include "puzzles.h"
+
+namespace {
+
+// Clears clues like removeClues, but counts the solutions of every candidate puzzle from scratch
+void removeCluesFromScratch(unsigned char *values, const unsigned *order, bool symmetric, const clue_filter_t &accept) {
+	for (unsigned i = 0; i < 81; i++) {
+		unsigned cell = order[i], mirror = symmetric ? 80 - cell : cell;
+		if (mirror < cell || values[cell] == 0) continue;
+		unsigned char value = values[cell], mirrorValue = values[mirror];
+		values[cell] = values[mirror] = 0;
+		if (countSolutions(Puzzle(9, values), 2) == 1 && (!accept || accept(values))) continue;
+		values[cell] = value;
+		values[mirror] = mirrorValue;
+	}
+}
+
+unsigned numClues(const unsigned char *values) {
+	unsigned clues = 0;
+	for (unsigned cell = 0; cell < 81; cell++) clues += values[cell] != 0;
+	return clues;
+}
+
+class GenerateTest : public HardPuzzleTest {
+	protected:
+		unsigned order[81];
+	public:
+		GenerateTest() {
+			for (unsigned cell = 0; cell < 81; cell++) order[cell] = cell;
+			Random random(5);
+			for (unsigned i = 80; i > 0; i--) std::swap(order[i], order[random.below(i + 1)]);
+		}
+};
+
+TEST_F(GenerateTest, TestRemovalLeavesMinimalUniquePuzzle) {
+	memcpy(values, solution, 81);
+	unsigned clues = removeClues(9, values, order);
+	EXPECT_EQ(clues, numClues(values));
+	EXPECT_EQ(countSolutions(Puzzle(9, values), 2), 1U);
+
+	// every clue left is necessary
+	for (unsigned cell = 0; cell < 81; cell++) {
+		if (!values[cell]) continue;
+		unsigned char value = values[cell];
+		values[cell] = 0;
+		EXPECT_EQ(countSolutions(Puzzle(9, values), 2), 2U) << "cell " << cell;
+		values[cell] = value;
+	}
+
+	unsigned char expected[81];
+	memcpy(expected, solution, 81);
+	removeCluesFromScratch(expected, order, false, nullptr);
+	EXPECT_EQ(memcmp(values, expected, 81), 0);
+}
+
+TEST_F(GenerateTest, TestSymmetricRemovalKeepsPairs) {
+	memcpy(values, solution, 81);
+	unsigned clues = removeClues(9, values, order, true);
+	EXPECT_EQ(clues, numClues(values));
+	EXPECT_EQ(countSolutions(Puzzle(9, values), 2), 1U);
+	for (unsigned cell = 0; cell < 81; cell++) EXPECT_EQ(values[cell] == 0, values[80 - cell] == 0) << "cell " << cell;
+
+	// every pair left is necessary
+	for (unsigned cell = 0; cell <= 40; cell++) {
+		if (!values[cell]) continue;
+		unsigned char value = values[cell], mirrorValue = values[80 - cell];
+		values[cell] = values[80 - cell] = 0;
+		EXPECT_EQ(countSolutions(Puzzle(9, values), 2), 2U) << "cell " << cell;
+		values[cell] = value;
+		values[80 - cell] = mirrorValue;
+	}
+
+	unsigned char expected[81];
+	memcpy(expected, solution, 81);
+	removeCluesFromScratch(expected, order, true, nullptr);
+	EXPECT_EQ(memcmp(values, expected, 81), 0);
+}
+
+TEST_F(GenerateTest, TestRejectedRemovalsRestoreTheGrid) {
+	// rejecting every removal that leaves the first row with fewer than five clues reverts
+	// removals the shared grid had already applied, so later counts must see them restored
+	unsigned rejected = 0;
+	clue_filter_t accept = [&rejected](unsigned char *values) {
+		unsigned clues = 0;
+		for (unsigned col = 0; col < 9; col++) clues += values[col] != 0;
+		rejected += clues < 5;
+		return clues >= 5;
+	};
+	memcpy(values, solution, 81);
+	unsigned clues = removeClues(9, values, order, false, accept);
+	EXPECT_GT(rejected, 0U);
+	EXPECT_EQ(clues, numClues(values));
+	EXPECT_GE(numClues(values), 5U);
+	EXPECT_EQ(countSolutions(Puzzle(9, values), 2), 1U);
+
+	unsigned char expected[81];
+	memcpy(expected, solution, 81);
+	removeCluesFromScratch(expected, order, false, accept);
+	EXPECT_EQ(memcmp(values, expected, 81), 0);
+}
+
+TEST_F(GenerateTest, TestUnreachableBandGivesUp) {
+	// no 4x4 puzzle rates above easy, so a medium band is never reached
+	EXPECT_EQ(hardestDifficulty(4), Difficulty::Easy);
+	generator_factory_t factory = [](unsigned worker) -> SudokuGenerator * {
+		MarkovAnnealingGenerator *generator = new MarkovAnnealingGenerator(4, 2, 0.05, 0.45, 0.5, worker + 1);
+		generator->setDifficulty(Difficulty::Medium, Difficulty::Medium);
+		return generator;
+	};
+	std::unique_ptr<SudokuGenerator> generator(factory(0));
+	Puzzle puzzle;
+	EXPECT_FALSE(generator->build(puzzle));
+
+	// a dataset stops once its workers give up rather than waiting on them
+	std::string filepath = ::testing::TempDir() + "unreachable.csv";
+	{
+		PuzzleDumper dumper(filepath, 4);
+		EXPECT_EQ(generateDataset(factory, dumper, 5, 2), 0UL);
+	}
+	std::remove(filepath.c_str());
+}
+
+}
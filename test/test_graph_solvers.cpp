@@ -0,0 +1,49 @@
+#include <puzzle.h>
+#include <solvers.h>
+#include <gtest/gtest.h>
+#include "puzzles.h"
+
+namespace {
+
+// Collapses a puzzle given as a string of digits, returning why the collapse stopped
+Solvers::GraphTermination collapse(Solvers::GraphSolver &solver, const char *digits) {
+	unsigned char values[81];
+	for (unsigned cell = 0; cell < 81; cell++) values[cell] = digits[cell] - '0';
+	Puzzle puzzle(9, values);
+	solver.solve(puzzle);
+	return solver.getTermination();
+}
+
+TEST(GraphSolverTest, TestSolvedTermination) {
+	Solvers::SimpleAdditiveGraphSolver solver(100);
+	EXPECT_EQ(collapse(solver, "503820476040050030060000008718000003926705000004006007100947005030210700000063810"),
+		Solvers::GraphTermination::Solved);
+	EXPECT_EQ(solver.getStatus(), SolveStatus::Solved);
+}
+
+TEST(GraphSolverTest, TestConvergedTermination) {
+	Solvers::SimpleAdditiveGraphSolver solver(100);
+	EXPECT_EQ(collapse(solver, "504000000000100800680002050065231000040000205003040008376020001159670420420003970"),
+		Solvers::GraphTermination::Converged);
+}
+
+TEST(GraphSolverTest, TestOscillatingTermination) {
+	Solvers::SimpleAdditiveGraphSolver solver(100);
+	EXPECT_EQ(collapse(solver, "280000931070310002030824070028630510005080000060540328000065097002090060601470000"),
+		Solvers::GraphTermination::Oscillating);
+}
+
+TEST(GraphSolverTest, TestStagnatedTermination) {
+	Solvers::MultiplicativeGraphSolver solver(100);
+	EXPECT_EQ(collapse(solver, "009104000350060010070050296005000004790001000600500129024016803080000002530048070"),
+		Solvers::GraphTermination::Stagnated);
+}
+
+TEST(GraphSolverTest, TestIterationLimitTermination) {
+	// still collapsing cells when the iterations run out
+	Solvers::SimpleAdditiveGraphSolver solver(100);
+	EXPECT_EQ(collapse(solver, HARD_PUZZLE), Solvers::GraphTermination::IterationLimit);
+	EXPECT_EQ(solver.getStatus(), SolveStatus::Unsolved);
+}
+
+}
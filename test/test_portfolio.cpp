@@ -0,0 +1,59 @@
+#include <puzzle.h>
+#include <solvers.h>
+#include <gtest/gtest.h>
+#include "puzzles.h"
+
+namespace {
+
+class PortfolioTest : public HardPuzzleTest {};
+
+TEST_F(PortfolioTest, TestRaceKeepsSolution) {
+	Puzzle puzzle(9, values);
+	Solvers::PortfolioSolver portfolio({new Solvers::DepthFirstSolver(), new Solvers::HybridGraphSolver(),
+		new Solvers::GeometricAnnealingSolver(20, 50, 0, 0.9)});
+	EXPECT_EQ(portfolio.solve(puzzle, solve_options_t()).status, SolveStatus::Solved);
+	EXPECT_TRUE(puzzle.isSolved());
+	ASSERT_GE(portfolio.getWinner(), 0);
+	EXPECT_EQ(portfolio.getWins(portfolio.getWinner()), 1U);
+}
+
+TEST_F(PortfolioTest, TestProofOfNoSolutionConcludes) {
+	Puzzle puzzle = contradictoryPuzzle();
+	Solvers::PortfolioSolver portfolio({new Solvers::AdditiveGraphSolver(100), new Solvers::HybridGraphSolver()});
+	EXPECT_EQ(portfolio.solve(puzzle, solve_options_t()).status, SolveStatus::Unsolvable);
+	EXPECT_EQ(portfolio.getWinner(), 1);
+}
+
+TEST_F(PortfolioTest, TestLearningTriesEveryEngine) {
+	// on one thread the first engine always concludes, until the untried engine is ranked ahead of it
+	for (unsigned row = 0; row < 9; row++) solution[row * 9 + row] = 0;
+	Puzzle puzzle(9, solution);
+	Solvers::PortfolioSolver portfolio({new Solvers::DepthFirstSolver(), new Solvers::HybridGraphSolver()}, 1);
+	portfolio.solve(puzzle);
+	EXPECT_EQ(portfolio.getWinner(), 0);
+	puzzle.reset();
+	portfolio.solve(puzzle);
+	EXPECT_EQ(portfolio.getWinner(), 1);
+	EXPECT_EQ(portfolio.getWins(0) + portfolio.getWins(1), 2U);
+
+	// without learning, the given order is kept
+	Solvers::PortfolioSolver fixed({new Solvers::DepthFirstSolver(), new Solvers::HybridGraphSolver()}, 1, false);
+	for (unsigned round = 0; round < 2; round++) {
+		puzzle.reset();
+		fixed.solve(puzzle);
+		EXPECT_EQ(fixed.getWinner(), 0);
+	}
+}
+
+TEST_F(PortfolioTest, TestCallerCancellation) {
+	Puzzle puzzle(9, values);
+	CancellationToken token;
+	token.cancel();
+	solve_options_t options;
+	options.cancellation = &token;
+	Solvers::PortfolioSolver portfolio({new Solvers::DepthFirstSolver(), new Solvers::HybridGraphSolver()});
+	EXPECT_EQ(portfolio.solve(puzzle, options).status, SolveStatus::Cancelled);
+	EXPECT_EQ(portfolio.getWinner(), -1);
+}
+
+}
@@ -92,6 +92,28 @@ TEST_F(PuzzleTest, TestOOBValuesUnsettable) {
 	}
 }
 
+TEST_F(PuzzleTest, TestOOBCellsUnsettable) {
+	EXPECT_EQ(puzzle.setValue(puzzleSizeSquared, 1), false);
+	EXPECT_EQ(puzzle.setValue(puzzleSizeSquared + 100U, 1), false);
+}
+
+TEST_F(PuzzleTest, TestSetValueUnchecked) {
+	puzzle.setValueUnchecked(1, 4);
+	EXPECT_EQ(puzzle.getValue(1), 4);
+	EXPECT_FALSE(puzzle.isConcrete(1));
+	puzzle.setValueUnchecked(1, 0);
+	EXPECT_EQ(puzzle.getValue(1), 0);
+}
+
+TEST_F(PuzzleTest, TestCopyKeepsSolution) {
+	unsigned char values[81] = {}, solution[81];
+	const char *solved = "812753649943682175675491283154237896369845721287169534521974368438526917796318452";
+	for (unsigned cell = 0; cell < 81; cell++) solution[cell] = solved[cell] - '0';
+	Puzzle original(9, values, solution);
+	Puzzle copy(original);
+	for (unsigned cell = 0; cell < 81; cell++) EXPECT_EQ(copy.getSolutionAt(cell), solution[cell]);
+}
+
 TEST_F(PuzzleTest, TestSetEmpty) {
 	for (int r = 0, c = 0; r < puzzleSize; c = (c+1) % puzzleSize, r = r + (c == 0)) {
 		if (r == c) continue;
@@ -0,0 +1,62 @@
+#include <trace.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+class TraceTest : public ::testing::Test {
+	protected:
+		TraceLog &log = TraceLog::GetInstance();
+	public:
+		TraceTest() { log.clear(); }
+		~TraceTest() { log.clear(); }
+};
+
+TEST_F(TraceTest, TestEventsAreOrdered) {
+	TraceLog::record(TRACE_SOLVE, TRACE_PHASE_BEGIN, 0, 0);
+	std::thread worker([]() { TraceLog::record(TRACE_BRANCH, TRACE_PHASE_INSTANT, 40, 3); });
+	worker.join();
+	TraceLog::record(TRACE_SOLVE, TRACE_PHASE_END, 0, 1);
+
+	std::vector<trace_event_t> events = log.collect();
+	ASSERT_EQ(events.size(), 3U);
+	EXPECT_EQ(events[0].phase, TRACE_PHASE_BEGIN);
+	EXPECT_EQ(events[1].event, TRACE_BRANCH);
+	EXPECT_EQ(events[1].cell, 40U);
+	EXPECT_EQ(events[1].value, 3U);
+	EXPECT_NE(events[1].thread, events[0].thread);
+	EXPECT_EQ(events[2].phase, TRACE_PHASE_END);
+	for (unsigned i = 1; i < events.size(); i++) EXPECT_LE(events[i - 1].timestamp, events[i].timestamp);
+}
+
+TEST_F(TraceTest, TestRingKeepsNewestEvents) {
+	for (unsigned i = 0; i < TRACE_BUFFER_EVENTS + 10; i++) TraceLog::record(TRACE_BACKTRACK, TRACE_PHASE_INSTANT, i, 0);
+
+	std::vector<trace_event_t> events = log.collect();
+	ASSERT_EQ(events.size(), TRACE_BUFFER_EVENTS);
+	EXPECT_EQ(events.front().cell, 10U);
+	EXPECT_EQ(events.back().cell, TRACE_BUFFER_EVENTS + 9);
+}
+
+TEST_F(TraceTest, TestFileRoundTrip) {
+	TraceLog::record(TRACE_HEAT, TRACE_PHASE_BEGIN, 0, 12);
+	TraceLog::record(TRACE_HEAT, TRACE_PHASE_END, 0, 0);
+	const char *filepath = "test_trace.bin";
+	ASSERT_TRUE(log.write(filepath));
+
+	std::vector<std::string> names;
+	std::vector<trace_event_t> events;
+	ASSERT_TRUE(TraceLog::read(filepath, names, events));
+	std::remove(filepath);
+	ASSERT_EQ(names.size(), static_cast<size_t>(TRACE_NUM_EVENTS));
+	EXPECT_EQ(names[TRACE_HEAT], traceEventName(TRACE_HEAT));
+	ASSERT_EQ(events.size(), 2U);
+	EXPECT_EQ(events[0].value, 12U);
+	EXPECT_EQ(events[1].phase, TRACE_PHASE_END);
+
+	EXPECT_FALSE(TraceLog::read("missing_trace.bin", names, events));
+}
+
+} // namespace
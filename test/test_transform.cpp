@@ -0,0 +1,52 @@
+#include <puzzle.h>
+#include <candidates.h>
+#include <transform.h>
+#include <gtest/gtest.h>
+#include "puzzles.h"
+
+namespace {
+
+class TransformTest : public HardPuzzleTest {
+	protected:
+		unsigned char target[81];
+		Random random;
+};
+
+TEST_F(TransformTest, TestIdentity) {
+	sudoku_transform_t transform = sudoku_transform_t::identity(9);
+	EXPECT_TRUE(transform.isValid());
+	transform.apply(solution, target);
+	for (unsigned cell = 0; cell < 81; cell++) EXPECT_EQ(target[cell], solution[cell]);
+}
+
+TEST_F(TransformTest, TestTranspose) {
+	sudoku_transform_t transform = sudoku_transform_t::identity(9);
+	transform.transpose = true;
+	transform.apply(solution, target);
+	for (unsigned row = 0; row < 9; row++)
+		for (unsigned col = 0; col < 9; col++) EXPECT_EQ(target[row * 9 + col], solution[col * 9 + row]);
+}
+
+TEST_F(TransformTest, TestRandomTransformsPreserveValidity) {
+	for (unsigned trial = 0; trial < 100; trial++) {
+		sudoku_transform_t transform = sudoku_transform_t::random(9, random);
+		ASSERT_TRUE(transform.isValid());
+		transform.apply(solution, target);
+		EXPECT_TRUE(isSudokuSolution(9, target));
+
+		// puzzles keep their clue count and their unique solution
+		transform.apply(values, target);
+		unsigned clues = 0;
+		for (unsigned cell = 0; cell < 81; cell++) clues += target[cell] != 0;
+		EXPECT_EQ(clues, 21U);
+		EXPECT_EQ(countSolutions(Puzzle(9, target), 2), 1U);
+	}
+}
+
+TEST_F(TransformTest, TestInvalidPermutation) {
+	sudoku_transform_t transform = sudoku_transform_t::identity(9);
+	std::swap(transform.rows[2], transform.rows[3]); // moves rows across bands
+	EXPECT_FALSE(transform.isValid());
+}
+
+} // namespace
@@ -0,0 +1,65 @@
+// standard libraries
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+// sudoku library
+#include "trace.h"
+
+using namespace std;
+
+// Converts a binary trace written by TraceLog::write (e.g. benchmark --trace) into
+// the Chrome trace event format, which chrome://tracing and ui.perfetto.dev open.
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        cerr << "Usage: trace_decode trace.bin trace.json\n";
+        return 1;
+    }
+
+    vector<string> names;
+    vector<trace_event_t> events;
+    if (!TraceLog::read(argv[1], names, events)) {
+        cerr << "Could not read trace " << argv[1] << '\n';
+        return 1;
+    }
+    ofstream out(argv[2]);
+    if (!out) {
+        cerr << "Could not write " << argv[2] << '\n';
+        return 1;
+    }
+
+    // timestamps are in microseconds from the first retained event. The ring buffers
+    // drop a thread's oldest events first, so ends whose beginning was overwritten are skipped.
+    uint64_t origin = events.empty() ? 0 : events.front().timestamp;
+    map<uint32_t, unsigned> openScopes;
+    unsigned written = 0, skipped = 0;
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    for (const trace_event_t &event : events) {
+        unsigned &open = openScopes[event.thread];
+        if (event.phase == TRACE_PHASE_BEGIN) open++;
+        else if (event.phase == TRACE_PHASE_END) {
+            if (open == 0) {
+                skipped++;
+                continue;
+            }
+            open--;
+        }
+        const string name = event.event < names.size() ? names[event.event] : "event " + to_string(event.event);
+        uint64_t nanoseconds = event.timestamp - origin;
+        out << (written++ ? ",\n" : "\n")
+            << "{\"name\": \"" << name << "\", \"ph\": \"" << static_cast<char>(event.phase) << "\""
+            << ", \"ts\": " << nanoseconds / 1000 << '.' << setw(3) << setfill('0') << nanoseconds % 1000 << setfill(' ')
+            << ", \"pid\": 1, \"tid\": " << event.thread;
+        if (event.phase == TRACE_PHASE_INSTANT) out << ", \"s\": \"t\"";
+        out << ", \"args\": {\"cell\": " << event.cell << ", \"value\": " << event.value << "}}";
+    }
+    out << "\n]}\n";
+
+    cout << "Wrote " << written << " events to " << argv[2];
+    if (skipped) cout << " (" << skipped << " unmatched ends skipped)";
+    cout << '\n';
+    return 0;
+}